@@ -4,35 +4,238 @@
 #include <linux/tty.h>      // For fg_console 
 #include <linux/kd.h>       // For KDSETLED 
 #include <linux/vt_kern.h>
+#include <linux/leds.h>
+#include <linux/mutex.h>
+#include <linux/spinlock.h>
+#include <linux/console.h>  // For console_lock
+#include <linux/notifier.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
 
 #define ALL_LEDS_ON 0x7
 #define ALL_LEDS_OFF 0
+#define NR_KBD_LEDS 3
 
 
-struct tty_driver* kbd_driver= NULL;
+static char *trigger = NULL;
+module_param(trigger, charp, 0444);
+MODULE_PARM_DESC(trigger, "Default trigger for every keyboard LED (timer, heartbeat...)");
 
+static int bench_calls = 0;
+module_param(bench_calls, int, 0444);
+MODULE_PARM_DESC(bench_calls, "If > 0, time this many LED updates at load time (cached vs lookup)");
 
-// Get driver handler
-struct tty_driver* get_kbd_driver_handler(void){
-   printk(KERN_INFO "modleds: loading\n");
-   printk(KERN_INFO "modleds: fgconsole is %x\n", fg_console);
-   return vc_cons[fg_console].d->port.tty->driver;
+/*
+ * Reference to the tty of the foreground console. Triggers may update the
+ * LEDs many times per second, so instead of walking
+ * vc_cons[fg_console].d->port.tty on every call we keep a refcounted tty
+ * and refresh it from the VT notifier. VT_UPDATE is sent on every VT
+ * switch but also on every write, region update and invert on the
+ * foreground console, so the notifier only refreshes when fg_console no
+ * longer matches cached_vc. Stores happen with console_lock held, like the
+ * notifier calls, so they cannot race each other. NULL means no tty was
+ * attached last time we looked.
+ */
+static DEFINE_SPINLOCK(tty_lock); // Protects cached_tty
+static struct tty_struct *cached_tty = NULL;
+static int cached_vc = -1;        // Console cached_tty belongs to (console_lock)
+
+/*
+ * The keyboard LEDs as led_classdevs (/sys/class/leds/modleds::*), one per
+ * KDSETLED bit, so in-kernel triggers can drive them. KDSETLED goes through
+ * the tty ioctl and may sleep, so they only have brightness_set_blocking:
+ * the LED core calls it from a workqueue and does blinking (timer trigger)
+ * itself.
+ */
+struct kbd_led {
+    struct led_classdev cdev;
+    unsigned int bit;
+};
+
+static struct kbd_led kbd_leds[NR_KBD_LEDS] = {
+    { .cdev = { .name = "modleds::scrolllock" }, .bit = 0x1 },
+    { .cdev = { .name = "modleds::numlock" },    .bit = 0x2 },
+    { .cdev = { .name = "modleds::capslock" },   .bit = 0x4 },
+};
+static DEFINE_MUTEX(leds_mutex); // Protects leds_mask
+static unsigned int leds_mask = ALL_LEDS_ON;
+static int nr_registered = 0;
+
+
+// Full lookup of the foreground console tty (caller holds console_lock)
+static struct tty_struct *fg_tty_locked(void)
+{
+    struct vc_data *vc = vc_cons[fg_console].d;
+
+    return vc ? tty_port_tty_get(&vc->port) : NULL;
+}
+
+// Replace the cached tty of console vc, taking over the reference passed in
+static void cache_tty(struct tty_struct *tty, int vc)
+{
+    struct tty_struct *old;
+    unsigned long flags;
+
+    cached_vc = vc;
+    spin_lock_irqsave(&tty_lock, flags);
+    old = cached_tty;
+    cached_tty = tty;
+    spin_unlock_irqrestore(&tty_lock, flags);
+    tty_kref_put(old);
+}
+
+// Get a reference to the foreground console tty, or NULL if there is none
+static struct tty_struct *get_fg_tty(void)
+{
+    struct tty_struct *tty;
+    unsigned long flags;
+
+    spin_lock_irqsave(&tty_lock, flags);
+    tty = tty_kref_get(cached_tty);
+    spin_unlock_irqrestore(&tty_lock, flags);
+    if (tty)
+        return tty;
+
+    // Nothing cached: the tty may have been opened since the last VT switch
+    console_lock();
+    tty = fg_tty_locked();
+    cache_tty(tty_kref_get(tty), fg_console);
+    console_unlock();
+    return tty;
+}
+
+static int vt_event(struct notifier_block *nb, unsigned long code, void *data)
+{
+    struct vt_notifier_param *param = data;
+
+    switch (code) {
+    case VT_UPDATE:
+        // Also sent on every write to the console: only act on a VT switch
+        if (param->vc->vc_num != fg_console || param->vc->vc_num == cached_vc)
+            break;
+        cache_tty(tty_port_tty_get(&param->vc->port), param->vc->vc_num);
+        break;
+    case VT_DEALLOCATE:
+        cache_tty(NULL, -1); // get_fg_tty() looks it up again
+        break;
+    }
+    return NOTIFY_OK;
+}
+
+static struct notifier_block vt_nb = {
+    .notifier_call = vt_event,
+};
+
+static int tty_set_leds(struct tty_struct *tty, unsigned int mask)
+{
+    if (!tty->ops->ioctl)
+        return -ENOTTY;
+    return tty->ops->ioctl(tty, KDSETLED, mask);
 }
 
 // Set led state to that specified by mask
-static inline int set_leds(struct tty_driver* handler, unsigned int mask){
-    return (handler->ops->ioctl) (vc_cons[fg_console].d->port.tty, KDSETLED,mask);
+static int set_leds(unsigned int mask){
+    struct tty_struct *tty = get_fg_tty();
+    int ret;
+
+    if (!tty)
+        return -ENODEV;
+    ret = tty_set_leds(tty, mask);
+    tty_kref_put(tty);
+    return ret;
+}
+
+static u64 calls_per_sec(s64 ns)
+{
+    return ns > 0 ? div64_u64((u64)bench_calls * NSEC_PER_SEC, ns) : 0;
+}
+
+// Compare the cached path against looking the tty up on every call
+static void run_bench(void)
+{
+    struct tty_struct *tty;
+    ktime_t t0;
+    s64 cached_ns, lookup_ns;
+    int i;
+
+    t0 = ktime_get();
+    for (i = 0; i < bench_calls; i++)
+        set_leds(i & ALL_LEDS_ON);
+    cached_ns = ktime_to_ns(ktime_sub(ktime_get(), t0));
+
+    t0 = ktime_get();
+    for (i = 0; i < bench_calls; i++) {
+        console_lock();
+        tty = fg_tty_locked();
+        console_unlock();
+        if (tty) {
+            tty_set_leds(tty, i & ALL_LEDS_ON);
+            tty_kref_put(tty);
+        }
+    }
+    lookup_ns = ktime_to_ns(ktime_sub(ktime_get(), t0));
+
+    pr_info("modleds: %d calls: cached %llu calls/s, lookup %llu calls/s\n",
+            bench_calls, calls_per_sec(cached_ns), calls_per_sec(lookup_ns));
+}
+
+static int kbd_led_set(struct led_classdev *cdev, enum led_brightness value)
+{
+    struct kbd_led *led = container_of(cdev, struct kbd_led, cdev);
+    int ret;
+
+    mutex_lock(&leds_mutex);
+    if (value)
+        leds_mask |= led->bit;
+    else
+        leds_mask &= ~led->bit;
+    ret = set_leds(leds_mask);
+    mutex_unlock(&leds_mutex);
+    return ret;
+}
+
+static void kbd_leds_unregister(void)
+{
+    while (nr_registered)
+        led_classdev_unregister(&kbd_leds[--nr_registered].cdev);
 }
 
 static int __init modleds_init(void)
 {	
-   kbd_driver= get_kbd_driver_handler();
-   set_leds(kbd_driver,ALL_LEDS_ON); 
+   int i, err;
+
+   printk(KERN_INFO "modleds: loading\n");
+   printk(KERN_INFO "modleds: fgconsole is %x\n", fg_console);
+   if ((err = register_vt_notifier(&vt_nb)))
+       return err;
+   if (set_leds(ALL_LEDS_ON) == -ENODEV)
+       pr_warn("modleds: no tty on the foreground console yet\n");
+   if (bench_calls > 0)
+       run_bench();
+
+   for (i = 0; i < NR_KBD_LEDS; i++) {
+       kbd_leds[i].cdev.max_brightness = 1;
+       kbd_leds[i].cdev.brightness = 1;
+       kbd_leds[i].cdev.brightness_set_blocking = kbd_led_set;
+       kbd_leds[i].cdev.default_trigger = trigger;
+       if ((err = led_classdev_register(NULL, &kbd_leds[i].cdev))) {
+           pr_err("modleds: cannot register %s\n", kbd_leds[i].cdev.name);
+           kbd_leds_unregister();
+           set_leds(ALL_LEDS_OFF);
+           unregister_vt_notifier(&vt_nb);
+           cache_tty(NULL, -1);
+           return err;
+       }
+       nr_registered++;
+   }
    return 0;
 }
 
 static void __exit modleds_exit(void){
-    set_leds(kbd_driver,ALL_LEDS_OFF); 
+    kbd_leds_unregister();
+    set_leds(ALL_LEDS_OFF); 
+    unregister_vt_notifier(&vt_nb);
+    cache_tty(NULL, -1);
 }
 
 module_init(modleds_init);
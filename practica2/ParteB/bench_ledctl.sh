@@ -0,0 +1,36 @@
+#!/bin/bash
+
+# Coste por cambio de LEDs lanzando un proceso ledctl_invoke por cambio
+# (como hacía contador.sh) frente a mandar todos los cambios en una sola
+# llamada a ledctl_batch con "ledctl_invoke -". Sin esperas entre pasos,
+# para medir solo la sobrecarga. Requiere el kernel con mi_parche.diff.
+# Uso (como root, en una consola virtual): ./bench_ledctl.sh [cambios]
+
+CAMBIOS=${1:-1000}
+
+make -s ledctl_invoke || exit 1
+
+ahora_ns() { date +%s%N; }
+
+t0=$(ahora_ns)
+for (( i=0; i<CAMBIOS; i++ )); do
+    ./ledctl_invoke $((i % 8)) || exit 1
+done
+t1=$(ahora_ns)
+
+# Se genera la secuencia antes para no medir el bucle de bash
+pasos=$(mktemp)
+for (( i=0; i<CAMBIOS; i++ )); do
+    echo "$((i % 8)) 0"
+done > $pasos
+t2=$(ahora_ns)
+./ledctl_invoke - < $pasos || exit 1
+t3=$(ahora_ns)
+rm -f $pasos
+./ledctl_invoke 0
+
+proceso=$(( (t1 - t0) / CAMBIOS ))
+lote=$(( (t3 - t2) / CAMBIOS ))
+echo "proceso por cambio: $proceso ns/cambio"
+echo "lote (ledctl_batch): $lote ns/cambio"
+[ $lote -gt 0 ] && echo "aceleración: x$(( proceso / lote ))"
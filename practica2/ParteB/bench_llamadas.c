@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#define SYS_ledctl 452  // Igual que en ledctl_invoke.c
+
+/*
+ * Microbenchmark de sys_ledctl: llamadas por segundo cambiando los LEDs en
+ * cada una, frente a getppid(), que no hace trabajo y sirve de referencia
+ * del coste de la propia llamada al sistema. Requiere el kernel con
+ * mi_parche.diff.
+ *
+ * Uso: ./bench_llamadas [llamadas]
+ */
+static double ahora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Devuelve llamadas/s recorriendo las 8 máscaras */
+static double medir_ledctl(long llamadas, int *error) {
+    double t0 = ahora_s();
+
+    *error = 0;
+    for (long i = 0; i < llamadas; i++) {
+        if (syscall(SYS_ledctl, (unsigned int)(i % 8)) == -1 && !*error)
+            *error = errno;
+    }
+    return llamadas / (ahora_s() - t0);
+}
+
+/* Devuelve llamadas/s de una llamada al sistema que no hace trabajo */
+static double medir_vacia(long llamadas) {
+    double t0 = ahora_s();
+
+    for (long i = 0; i < llamadas; i++)
+        syscall(SYS_getppid);
+    return llamadas / (ahora_s() - t0);
+}
+
+int main(int argc, char *argv[]) {
+    long llamadas = argc > 1 ? atol(argv[1]) : 100000;
+    double validas, vacias;
+    int error;
+
+    if (llamadas <= 0) {
+        fprintf(stderr, "Uso: %s [llamadas]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    validas = medir_ledctl(llamadas, &error);
+    if (error) {
+        errno = error;
+        perror("ledctl");
+        return EXIT_FAILURE;
+    }
+    vacias = medir_vacia(llamadas);
+    syscall(SYS_ledctl, 0);
+
+    printf("%ld llamadas\n", llamadas);
+    printf("cambiando LEDs: %.0f llamadas/s (%.2f us/llamada)\n", validas, 1e6 / validas);
+    printf("solo syscall (getppid): %.0f llamadas/s (%.2f us/llamada)\n",
+           vacias, 1e6 / vacias);
+    return EXIT_SUCCESS;
+}
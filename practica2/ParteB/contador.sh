@@ -1,10 +1,12 @@
 #!/bin/bash
 
+# Contador binario en los LEDs del teclado. Cada vuelta de 8 valores es un
+# solo proceso y una sola llamada a ledctl_batch, en vez de un
+# "sudo ./ledctl_invoke $i" por cambio.
 while true
 do
    for (( i=0; $i<8 ; i++ ))
    do
-      sudo ./ledctl_invoke $i
-      sleep 0.5
-    done
-done
\ No newline at end of file
+      echo "$i 500"
+   done | sudo ./ledctl_invoke -
+done
@@ -1,16 +1,79 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/syscall.h>
 
-#define SYS_ledctl 452  // Este número debe coincidir con el número que agregaste en syscall_64.tbl
+#define SYS_ledctl 452        // Este número debe coincidir con el número que agregaste en syscall_64.tbl
+#define SYS_ledctl_batch 453  // Idem para ledctl_batch
+#define MAX_PASOS 1024        // LEDCTL_MAX_PASOS en kernel/ledctl.c
+
+/* Un paso de ledctl_batch: mismo formato que en kernel/ledctl.c */
+struct ledctl_paso {
+    unsigned int mask;
+    unsigned int delay_ms;
+};
+
+/*
+ * Con "-" lee de la entrada estándar una secuencia de líneas "mask delay_ms"
+ * y la aplica entera con una sola llamada a ledctl_batch (en tandas de
+ * MAX_PASOS si es más larga). Las líneas en blanco se ignoran; una línea
+ * mal formada termina con error (las tandas anteriores ya se aplicaron).
+ */
+static int invocar_lote(void) {
+    static struct ledctl_paso pasos[MAX_PASOS];
+    char linea[128], resto;
+    unsigned int n = 0, num_linea = 0;
+    long result;
+    int fin = 0;
+
+    while (!fin) {
+        if (fgets(linea, sizeof(linea), stdin) == NULL) {
+            if (!feof(stdin)) {
+                perror("Error al leer la entrada estándar");
+                return 1;
+            }
+            fin = 1;
+        } else {
+            num_linea++;
+            if (sscanf(linea, " %c", &resto) != 1)
+                continue; // Línea en blanco
+            if (sscanf(linea, "%u %u %c", &pasos[n].mask, &pasos[n].delay_ms, &resto) != 2) {
+                linea[strcspn(linea, "\n")] = '\0';
+                fprintf(stderr, "Línea %u mal formada (se esperaba \"mask delay_ms\"): %s\n",
+                        num_linea, linea);
+                return 1;
+            }
+            n++;
+        }
+        if (n == 0 || (!fin && n < MAX_PASOS))
+            continue;
+
+        result = syscall(SYS_ledctl_batch, pasos, n);
+        if (result == -1) {
+            perror("Error al invocar ledctl_batch");
+            return 1;
+        }
+        if (result != n) {
+            fprintf(stderr, "ledctl_batch: solo se aplicaron %ld de %u pasos\n", result, n);
+            return 1;
+        }
+        n = 0;
+    }
+
+    return 0;
+}
 
 int main(int argc, char *argv[]) {
     if (argc != 2) {
-        fprintf(stderr, "Uso: %s <mask>\n", argv[0]);
+        fprintf(stderr, "Uso: %s <mask>\n       %s -   (pasos \"mask delay_ms\" por la entrada estándar)\n",
+                argv[0], argv[0]);
         return 1;
     }
 
+    if (strcmp(argv[1], "-") == 0)
+        return invocar_lote();
+
     unsigned int mask = atoi(argv[1]);
    
     
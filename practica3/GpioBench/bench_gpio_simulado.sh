@@ -0,0 +1,16 @@
+#!/bin/bash
+
+# Ejecuta gpio-bench sobre un chip simulado con 3, 8 y 32 líneas.
+# Uso (como root, desde este directorio): ./bench_gpio_simulado.sh
+
+source ../TestBee/gpio_simulado.sh
+
+base=$(gpio_simulado_crear 32) || exit 1
+
+for n in 3 8 32; do
+    insmod gpio-bench.ko gpios=$(gpio_simulado_lineas $base $n) iteraciones=100000 || exit 1
+    rmmod gpio-bench
+done
+dmesg | grep gpio_bench | tail -9
+
+gpio_simulado_destruir
@@ -0,0 +1,96 @@
+#include <linux/module.h>
+#include <asm-generic/errno.h>
+#include <linux/gpio.h>
+#include <linux/ktime.h>
+
+MODULE_DESCRIPTION("Microbenchmark de escrituras GPIO línea a línea frente a array");
+MODULE_AUTHOR("Lucas Calzada y Juan Girón");
+MODULE_LICENSE("GPL");
+
+/*
+ * Compara el coste de fijar un grupo de líneas con un gpiod_set_value() por
+ * línea (como hacía set_pi_leds()) y con un único gpiod_set_array_value().
+ * El resultado se imprime al cargar el módulo:
+ *
+ *   sudo insmod gpio-bench.ko gpios=25,27,4 iteraciones=100000
+ */
+#define MAX_GPIOS 32
+
+static int gpios[MAX_GPIOS] = {25, 27, 4};
+static int num_gpios = 3;
+module_param_array(gpios, int, &num_gpios, 0444);
+MODULE_PARM_DESC(gpios, "GPIOs a escribir");
+
+static int iteraciones = 100000;
+module_param(iteraciones, int, 0444);
+MODULE_PARM_DESC(iteraciones, "Actualizaciones por método");
+
+static struct gpio_desc *descs[MAX_GPIOS];
+
+static u64 medir_por_linea(void)
+{
+  u64 t0 = ktime_get_ns();
+  int it, i;
+
+  for (it = 0; it < iteraciones; it++)
+    for (i = 0; i < num_gpios; i++)
+      gpiod_set_value(descs[i], (it >> i) & 0x1);
+
+  return ktime_get_ns() - t0;
+}
+
+static u64 medir_array(void)
+{
+  u64 t0 = ktime_get_ns();
+  unsigned long valores;
+  int it;
+
+  for (it = 0; it < iteraciones; it++) {
+    valores = it;
+    gpiod_set_array_value(num_gpios, descs, NULL, &valores);
+  }
+
+  return ktime_get_ns() - t0;
+}
+
+static int __init gpio_bench_init(void)
+{
+  int i, j, err;
+  u64 t_linea, t_array;
+
+  if (iteraciones <= 0)
+    return -EINVAL;
+
+  for (i = 0; i < num_gpios; i++) {
+    if ((err = gpio_request(gpios[i], "gpio_bench"))) {
+      pr_err("Failed GPIO %d request\n", gpios[i]);
+      goto err_handle;
+    }
+    descs[i] = gpio_to_desc(gpios[i]);
+    gpiod_direction_output(descs[i], 0);
+  }
+
+  t_linea = medir_por_linea();
+  t_array = medir_array();
+
+  pr_info("gpio_bench: %d lineas, %d iteraciones\n", num_gpios, iteraciones);
+  pr_info("gpio_bench: por linea: %llu ns/actualizacion\n", div_u64(t_linea, iteraciones));
+  pr_info("gpio_bench: array:     %llu ns/actualizacion\n", div_u64(t_array, iteraciones));
+
+  return 0;
+err_handle:
+  for (j = 0; j < i; j++)
+    gpio_free(gpios[j]);
+  return err;
+}
+
+static void __exit gpio_bench_exit(void)
+{
+  int i;
+
+  for (i = 0; i < num_gpios; i++)
+    gpio_free(gpios[i]);
+}
+
+module_init(gpio_bench_init);
+module_exit(gpio_bench_exit);
@@ -0,0 +1,61 @@
+#!/bin/bash
+
+# Coste de CPU de hacer parpadear los LEDs con nuestro bucle de temporizador
+# (timerleds de la práctica 5) frente al trigger "timer" del núcleo sobre
+# los led_classdev de modleds-pi-gpiod, con blink_set (hrtimer del driver)
+# y sin él (parpadeo software del núcleo LED). Todo sobre un chip GPIO
+# simulado y con el mismo periodo.
+# El coste es el tiempo de sistema + irq + softirq de /proc/stat durante la
+# medida, menos el de la misma medida en reposo.
+# Uso (como root, desde este directorio): ./comparar_cpu.sh [periodo_ms] [segundos]
+
+source ../TestBee/gpio_simulado.sh
+
+PERIODO_MS=${1:-10}
+SEGUNDOS=${2:-10}
+TIMERLEDS=../../practica5/PARTEA/timerleds.ko
+HZ_USUARIO=$(getconf CLK_TCK)
+
+# Suma de system, irq y softirq de todas las CPU, en ms
+cpu_kernel_ms() {
+    awk -v hz=$HZ_USUARIO '/^cpu / { print ($4 + $7 + $8) * 1000 / hz }' /proc/stat
+}
+
+medir() {
+    local t0=$(cpu_kernel_ms)
+    sleep $SEGUNDOS
+    awk -v a=$t0 -v b=$(cpu_kernel_ms) 'BEGIN { print b - a }'
+}
+
+base=$(gpio_simulado_crear 4) || exit 1
+leds=$(gpio_simulado_lineas $base 3)
+
+reposo=$(medir)
+echo "reposo: ${reposo} ms de CPU en ${SEGUNDOS} s"
+
+informe() {
+    echo "$1: $(awk -v a=$reposo -v b=$2 'BEGIN { print b - a }') ms de CPU sobre el reposo"
+}
+
+# Nuestro bucle: timerleds cambia los tres LEDs en cada periodo
+insmod $TIMERLEDS modo=hrtimer timer_period_ms=$PERIODO_MS \
+    led_gpio=$leds button_gpio=$((base + 3)) || exit 1
+informe "timerleds (hrtimer)" $(medir)
+rmmod timerleds
+
+for offload in 1 0; do
+    insmod modleds-pi-gpiod.ko led_gpio=$leds blink_hrtimer=$offload || exit 1
+    for d in 1 2 3; do
+        echo timer > /sys/class/leds/bee::d$d/trigger
+        echo $PERIODO_MS > /sys/class/leds/bee::d$d/delay_on
+        echo $PERIODO_MS > /sys/class/leds/bee::d$d/delay_off
+    done
+    if [ $offload = 1 ]; then
+        informe "trigger timer + blink_set (hrtimer)" $(medir)
+    else
+        informe "trigger timer (parpadeo software)" $(medir)
+    fi
+    rmmod modleds-pi-gpiod
+done
+
+gpio_simulado_destruir
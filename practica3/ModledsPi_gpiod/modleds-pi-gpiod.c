@@ -1,6 +1,8 @@
 #include <linux/module.h>
 #include <asm-generic/errno.h>
 #include <linux/gpio.h>
+#include <linux/hrtimer.h>
+#include <linux/leds.h>
 
 #define ALL_LEDS_ON 0x7
 #define ALL_LEDS_OFF 0
@@ -11,19 +13,95 @@ MODULE_AUTHOR("Juan Carlos Saez");
 MODULE_LICENSE("GPL");
 
 /* Actual GPIOs used for controlling LEDs */
-const int led_gpio[NR_GPIO_LEDS] = {25, 27, 4};
+static int led_gpio[NR_GPIO_LEDS] = {25, 27, 4};
+module_param_array(led_gpio, int, NULL, 0444);
+MODULE_PARM_DESC(led_gpio, "LED GPIOs");
+
+static char *trigger = NULL;
+module_param(trigger, charp, 0444);
+MODULE_PARM_DESC(trigger, "Default trigger for every LED (timer, heartbeat, netdev...)");
+
+static bool blink_hrtimer = true;
+module_param(blink_hrtimer, bool, 0444);
+MODULE_PARM_DESC(blink_hrtimer, "Offload blinking to a per-LED hrtimer (blink_set); if 0 the LED core blinks in software");
 
 /* Array to hold gpio descriptors */
 struct gpio_desc* gpio_descriptors[NR_GPIO_LEDS];
 
-/* Set led state to that specified by mask */
+/*
+ * Each GPIO is also a led_classdev (/sys/class/leds/bee::dN), so in-kernel
+ * triggers can drive it. blink_set() hands the timer trigger an hrtimer
+ * that flips the line with exact on/off times, instead of the LED core's
+ * jiffies-based software blink.
+ */
+struct bee_led {
+  struct led_classdev cdev;
+  struct gpio_desc *desc;
+  struct hrtimer blink;
+  ktime_t on, off;
+  bool lit;
+  char name[16];
+};
+
+static struct bee_led bee_leds[NR_GPIO_LEDS];
+static int nr_registered = 0;
+
+/* Set led state to that specified by mask (all lines in one call) */
 static inline int set_pi_leds(unsigned int mask) {
-  int i;
-  for (i = 0; i < NR_GPIO_LEDS; i++)
-    gpiod_set_value(gpio_descriptors[i], (mask >> i) & 0x1 );
+  unsigned long values = mask;
+  return gpiod_set_array_value(NR_GPIO_LEDS, gpio_descriptors, NULL, &values);
+}
+
+static void bee_led_set(struct led_classdev *cdev, enum led_brightness value)
+{
+  struct bee_led *led = container_of(cdev, struct bee_led, cdev);
+
+  /* The core calls this to stop blinking too (brightness 0 or a new trigger) */
+  hrtimer_cancel(&led->blink);
+  gpiod_set_value(led->desc, value != LED_OFF);
+}
+
+static enum hrtimer_restart bee_led_blink(struct hrtimer *timer)
+{
+  struct bee_led *led = container_of(timer, struct bee_led, blink);
+
+  led->lit = !led->lit;
+  gpiod_set_value(led->desc, led->lit);
+  hrtimer_forward_now(timer, led->lit ? led->on : led->off);
+  return HRTIMER_RESTART;
+}
+
+static int bee_led_blink_set(struct led_classdev *cdev, unsigned long *delay_on,
+                             unsigned long *delay_off)
+{
+  struct bee_led *led = container_of(cdev, struct bee_led, cdev);
+
+  /* Same default as the LED core: 1 Hz */
+  if (!*delay_on && !*delay_off)
+    *delay_on = *delay_off = 500;
+
+  hrtimer_cancel(&led->blink);
+  led->on = ms_to_ktime(*delay_on);
+  led->off = ms_to_ktime(*delay_off);
+  led->lit = *delay_on != 0;
+  gpiod_set_value(led->desc, led->lit);
+  /* Solid on or off: nothing to toggle */
+  if (*delay_on && *delay_off)
+    hrtimer_start(&led->blink, led->lit ? led->on : led->off, HRTIMER_MODE_REL);
   return 0;
 }
 
+static void bee_leds_unregister(void)
+{
+  struct bee_led *led;
+
+  while (nr_registered) {
+    led = &bee_leds[--nr_registered];
+    led_classdev_unregister(&led->cdev);
+    hrtimer_cancel(&led->blink);
+  }
+}
+
 static int __init modleds_init(void)
 {
   int i, j;
@@ -50,7 +128,33 @@ static int __init modleds_init(void)
   }
 
   set_pi_leds(ALL_LEDS_ON);
+
+  for (j = 0; j < NR_GPIO_LEDS; j++) {
+    struct bee_led *led = &bee_leds[j];
+
+    led->desc = gpio_descriptors[j];
+    hrtimer_init(&led->blink, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    led->blink.function = bee_led_blink;
+
+    snprintf(led->name, sizeof(led->name), "bee::d%d", j + 1);
+    led->cdev.name = led->name;
+    led->cdev.max_brightness = 1;
+    led->cdev.brightness = 1;
+    led->cdev.brightness_set = bee_led_set;
+    if (blink_hrtimer)
+      led->cdev.blink_set = bee_led_blink_set;
+    led->cdev.default_trigger = trigger;
+
+    if ((err = led_classdev_register(NULL, &led->cdev))) {
+      pr_err("Failed to register LED %s\n", led->name);
+      goto err_leds;
+    }
+    nr_registered++;
+  }
   return 0;
+err_leds:
+  bee_leds_unregister();
+  set_pi_leds(ALL_LEDS_OFF);
 err_handle:
   for (j = 0; j < i; j++)
     gpiod_put(gpio_descriptors[j]);
@@ -60,6 +164,7 @@ err_handle:
 static void __exit modleds_exit(void) {
   int i = 0;
 
+  bee_leds_unregister();
   set_pi_leds(ALL_LEDS_OFF);
 
   for (i = 0; i < NR_GPIO_LEDS; i++)
@@ -0,0 +1,24 @@
+#!/bin/bash
+
+# Actualizaciones por segundo de /dev/leds según el número de LEDs, sobre un
+# chip GPIO simulado de 64 líneas, con máscaras en texto y en binario. Con
+# las operaciones de array el coste por actualización apenas debe crecer
+# con el número de LEDs.
+# Uso (como root, desde este directorio): ./bench_leds.sh [segundos]
+
+source ../TestBee/gpio_simulado.sh
+
+SEGUNDOS=${1:-2}
+
+make -s benchleds || exit 1
+base=$(gpio_simulado_crear 64) || exit 1
+
+for n in 1 3 8 16 32 64; do
+    rmmod ledspi 2>/dev/null
+    insmod ledspi.ko led_gpio=$(gpio_simulado_lineas $base $n) || exit 1
+    ./benchleds texto $n $SEGUNDOS
+    ./benchleds bin $n $SEGUNDOS
+done
+
+rmmod ledspi
+gpio_simulado_destruir
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * Mide cuántas actualizaciones completas de los LEDs por segundo admite el
+ * driver: cada write() cambia todas las líneas a la vez. Alterna dos
+ * máscaras complementarias para que todas las líneas cambien siempre.
+ *
+ * Uso: ./benchleds <texto|bin> num_leds [segundos]
+ *   texto: "0x..." en /dev/leds    bin: u64 en /dev/leds_bin
+ */
+static double ahora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    int binario, num_leds, fd;
+    double segundos = 2, t0, dt;
+    uint64_t todos, mascaras[2];
+    char texto[2][24];
+    int largo[2];
+    long n = 0;
+
+    if (argc < 3) {
+        fprintf(stderr, "Uso: %s <texto|bin> num_leds [segundos]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    binario = strcmp(argv[1], "bin") == 0;
+    num_leds = atoi(argv[2]);
+    if (argc > 3)
+        segundos = atof(argv[3]);
+    if (num_leds < 1 || num_leds > 64) {
+        fprintf(stderr, "num_leds entre 1 y 64\n");
+        return EXIT_FAILURE;
+    }
+
+    todos = num_leds == 64 ? ~0ULL : (1ULL << num_leds) - 1;
+    mascaras[0] = 0x5555555555555555ULL & todos;
+    mascaras[1] = ~mascaras[0] & todos;
+    for (int i = 0; i < 2; i++)
+        largo[i] = snprintf(texto[i], sizeof(texto[i]), "0x%llx\n", (unsigned long long)mascaras[i]);
+
+    fd = open(binario ? "/dev/leds_bin" : "/dev/leds", O_WRONLY);
+    if (fd == -1) {
+        perror("Error al abrir el dispositivo");
+        return EXIT_FAILURE;
+    }
+
+    t0 = ahora_s();
+    do {
+        /* Se consulta el reloj cada 1024 escrituras para no medirlo a él */
+        for (int i = 0; i < 1024; i++, n++) {
+            int r = binario ? write(fd, &mascaras[n & 1], sizeof(uint64_t))
+                            : write(fd, texto[n & 1], largo[n & 1]);
+            if (r == -1) {
+                perror("Error al escribir en el dispositivo");
+                return EXIT_FAILURE;
+            }
+        }
+        dt = ahora_s() - t0;
+    } while (dt < segundos);
+    close(fd);
+
+    printf("%s leds=%d actualizaciones/s=%.0f ns/actualizacion=%.0f\n",
+           binario ? "bin" : "texto", num_leds, n / dt, dt * 1e9 / n);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,46 @@
+/*
+ * leds.h
+ *
+ * Interfaz compartida entre el driver ledspi y los programas de usuario
+ * que reproducen patrones en /dev/leds.
+ *
+ * Las máscaras son de 64 bits: el bit i corresponde al LED i-ésimo de
+ * led_gpio (bit 0 = D1 en la placa Bee). En /dev/leds se escriben como
+ * texto (decimal o 0x hexadecimal) y en /dev/leds_bin como un __u64 binario.
+ *
+ * Un patrón es un vector de pasos; cada paso trae la máscara de LEDs y el
+ * tiempo que se mantiene. El driver lo reproduce desde un
+ * hrtimer con plazos absolutos, así que el retraso de un paso no se
+ * acumula en los siguientes; si uno llega tarde, los plazos ya vencidos se
+ * saltan en lugar de recuperarse de golpe. Cualquier write() lo detiene.
+ */
+#ifndef LEDS_H
+#define LEDS_H
+
+#include <linux/types.h>
+#include <linux/ioctl.h>
+
+#define LEDS_MAX_LINEAS 64
+#define LEDS_MAX_PASOS 4096
+#define LEDS_MIN_DURACION_US 10 // Pasos más cortos se rechazan con EINVAL
+
+struct leds_paso {
+    __u64 mascara;      // Solo bits de LEDs configurados
+    __u32 duracion_us;  // >= LEDS_MIN_DURACION_US
+    __u32 relleno;
+};
+
+struct leds_patron {
+    __u64 pasos;         // Puntero a struct leds_paso[num_pasos]
+    __u32 num_pasos;     // 1..LEDS_MAX_PASOS
+    __u32 repeticiones;  // Vueltas completas; 0 = en bucle hasta parar
+};
+
+#define LEDS_IOC_MAGIC 'l'
+
+/* Sustituye el patrón en curso (si lo hay) y empieza a reproducir */
+#define LEDS_IOC_PATRON _IOW(LEDS_IOC_MAGIC, 1, struct leds_patron)
+/* Detiene el patrón dejando los LEDs como estén */
+#define LEDS_IOC_PARAR  _IO(LEDS_IOC_MAGIC, 2)
+
+#endif /* LEDS_H */
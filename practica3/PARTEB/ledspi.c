@@ -6,30 +6,46 @@
 #include <linux/cdev.h>
 #include <linux/miscdevice.h>
 #include <linux/gpio.h>
+#include <linux/hrtimer.h>
+#include <linux/ktime.h>
+#include <linux/mutex.h>
+#include <linux/slab.h>
+#include <linux/bitmap.h>
+#include <linux/seqlock.h>
+#include <linux/ctype.h>
+#include "leds.h"
 
 #define SUCCESS 0
 #define DEVICE_NAME "leds"
 #define CLASS_NAME "led"
-#define MAX_LED_VALUE 7
 #define MIN_LED_VALUE 0
 #define BUF_LEN 80      /* Max length of the message from the device */
-#define NR_GPIO_LEDS 3
+#define MAX_LEDS LEDS_MAX_LINEAS
 
 
 static struct class* ledClass = NULL;
 static struct device* ledDevice = NULL;
-static int led_value = 0; // Estado inicial de los LEDs
+static u64 led_value = 0; // Estado inicial de los LEDs
 
-const int led_gpio[NR_GPIO_LEDS]={25,27,4};
-struct gpio_desc* gpio_descriptors[NR_GPIO_LEDS];
+/* Por defecto los LEDs D1-D3 de la placa Bee; el bit i de la máscara es led_gpio[i] */
+static int led_gpio[MAX_LEDS]={25,27,4};
+static int nr_gpio_leds = 3;
+module_param_array_named(led_gpio, led_gpio, int, &nr_gpio_leds, 0444);
+MODULE_PARM_DESC(led_gpio, "GPIOs de los LEDs (hasta 64)");
+struct gpio_desc* gpio_descriptors[MAX_LEDS];
 
 static ssize_t dev_write(struct file* filep, const char* buffer, size_t len, loff_t* offset);
+static ssize_t dev_write_bin(struct file* filep, const char* buffer, size_t len, loff_t* offset);
+static long dev_ioctl(struct file* filep, unsigned int cmd, unsigned long arg);
+static const struct attribute_group *leds_groups[];
 
 
 // Definición de las operaciones del dispositivo
 static struct file_operations fops = {
     .owner = THIS_MODULE,
     .write = dev_write,
+    .unlocked_ioctl = dev_ioctl,
+    .compat_ioctl = compat_ptr_ioctl,
 };
 
 static struct miscdevice misc_leds = {
@@ -37,21 +53,224 @@ static struct miscdevice misc_leds = {
     .name = DEVICE_NAME, /* when misc_register() is invoked, the kernel*/
     .mode = 0666,     /* ... dev node perms set as specified here */
     .fops = &fops,    /* connect to this driver's 'functionality' */
+    .groups = leds_groups,
 };
 
+/* /dev/leds_bin: la misma máscara como u64 binario, sin parseo de texto */
+static struct file_operations fops_bin = {
+    .owner = THIS_MODULE,
+    .write = dev_write_bin,
+    .unlocked_ioctl = dev_ioctl,
+    .compat_ioctl = compat_ptr_ioctl,
+};
 
-static inline int set_pi_leds(unsigned int mask){
-    int i;
-    for (i=0;i<NR_GPIO_LEDS;i++)
-        gpiod_set_value(gpio_descriptors[i], (mask>>i) & 0x1 );
-    return 0;
+static struct miscdevice misc_leds_bin = {
+    .minor = MISC_DYNAMIC_MINOR,
+    .name = DEVICE_NAME "_bin",
+    .mode = 0666,
+    .fops = &fops_bin,
+};
+
+
+/*
+ * Todas las líneas en una sola llamada: el núcleo GPIO agrupa por chip, así
+ * que el coste crece con los chips y no con los LEDs. El bitmap no es un
+ * unsigned long a secas porque en la Pi de 32 bits no caben 64 LEDs.
+ */
+static inline int set_pi_leds(u64 mask){
+    DECLARE_BITMAP(valores, MAX_LEDS);
+
+    bitmap_from_u64(valores, mask);
+    return gpiod_set_array_value(nr_gpio_leds, gpio_descriptors, NULL, valores);
+}
+
+/*
+ * Última máscara aplicada, la escriba write() o el hrtimer del patrón. Es
+ * un u64 y en la Pi de 32 bits su lectura no es atómica: va con un seqlock.
+ */
+static DEFINE_SEQLOCK(led_lock);
+
+static void guardar_mascara(u64 mask)
+{
+    unsigned long flags;
+
+    write_seqlock_irqsave(&led_lock, flags);
+    led_value = mask;
+    write_sequnlock_irqrestore(&led_lock, flags);
+}
+
+static u64 leer_mascara(void)
+{
+    unsigned int seq;
+    u64 mask;
+
+    do {
+        seq = read_seqbegin(&led_lock);
+        mask = led_value;
+    } while (read_seqretry(&led_lock, seq));
+    return mask;
 }
-// Función de escritura para el dispositivo /dev/leds
+
+static inline bool mascara_valida(u64 mask)
+{
+    return nr_gpio_leds == 64 || !(mask >> nr_gpio_leds);
+}
+
+/* Patrones (ioctl LEDS_IOC_PATRON) */
+static DEFINE_MUTEX(patron_mutex);        // Serializa arranque y parada
+static struct hrtimer patron_timer;
+static struct leds_paso *patron_pasos = NULL; // Solo cambia con el timer parado
+static u32 patron_num = 0, patron_repeticiones = 0;
+static u32 patron_actual = 0, patron_vuelta = 0;
+static bool patron_activo = false;
+static u64 patron_aplicados = 0;          // Pasos aplicados en el patrón actual
+static u64 patron_retraso_total_ns = 0, patron_retraso_max_ns = 0;
+static u64 patron_saltos = 0;             // Plazos perdidos por pasos que llegaron tarde
+
+/*
+ * hrtimer: aplica el paso actual y programa el siguiente en plazo
+ * absoluto. Si el paso llegó tarde, el siguiente plazo se lleva al primer
+ * múltiplo de su duración que aún no ha pasado (en lugar de disparar
+ * seguidos los pasos atrasados) y los plazos saltados se cuentan.
+ */
+static enum hrtimer_restart patron_fn(struct hrtimer *timer)
+{
+    u64 retraso = ktime_get_ns() - ktime_to_ns(hrtimer_get_expires(timer));
+    struct leds_paso *p = &patron_pasos[patron_actual];
+
+    set_pi_leds(p->mascara);
+    guardar_mascara(p->mascara);
+
+    patron_aplicados++;
+    patron_retraso_total_ns += retraso;
+    if (retraso > patron_retraso_max_ns)
+        patron_retraso_max_ns = retraso;
+
+    patron_saltos += hrtimer_forward_now(timer, ns_to_ktime((u64)p->duracion_us * NSEC_PER_USEC)) - 1;
+
+    if (++patron_actual == patron_num) {
+        patron_actual = 0;
+        if (patron_repeticiones && ++patron_vuelta == patron_repeticiones) {
+            WRITE_ONCE(patron_activo, false);
+            return HRTIMER_NORESTART;
+        }
+    }
+    return HRTIMER_RESTART;
+}
+
+/* Para el patrón en curso. Llamar con patron_mutex */
+static void parar_patron_locked(void)
+{
+    hrtimer_cancel(&patron_timer);
+    WRITE_ONCE(patron_activo, false);
+    kfree(patron_pasos);
+    patron_pasos = NULL;
+}
+
+static void parar_patron(void)
+{
+    mutex_lock(&patron_mutex);
+    if (patron_pasos)
+        parar_patron_locked();
+    mutex_unlock(&patron_mutex);
+}
+
+static long dev_ioctl(struct file* filep, unsigned int cmd, unsigned long arg)
+{
+    struct leds_patron a;
+    struct leds_paso *pasos;
+    u32 i;
+
+    switch (cmd) {
+    case LEDS_IOC_PATRON:
+        if (copy_from_user(&a, (void __user *)arg, sizeof(a)))
+            return -EFAULT;
+        if (a.num_pasos < 1 || a.num_pasos > LEDS_MAX_PASOS)
+            return -EINVAL;
+
+        pasos = memdup_user(u64_to_user_ptr(a.pasos), a.num_pasos * sizeof(*pasos));
+        if (IS_ERR(pasos))
+            return PTR_ERR(pasos);
+        for (i = 0; i < a.num_pasos; i++) {
+            if (pasos[i].duracion_us < LEDS_MIN_DURACION_US || !mascara_valida(pasos[i].mascara)) {
+                kfree(pasos);
+                return -EINVAL;
+            }
+        }
+
+        mutex_lock(&patron_mutex);
+        parar_patron_locked();
+        patron_pasos = pasos;
+        patron_num = a.num_pasos;
+        patron_repeticiones = a.repeticiones;
+        patron_actual = 0;
+        patron_vuelta = 0;
+        patron_aplicados = 0;
+        patron_retraso_total_ns = 0;
+        patron_retraso_max_ns = 0;
+        patron_saltos = 0;
+        patron_activo = true;
+        hrtimer_start(&patron_timer, ktime_get(), HRTIMER_MODE_ABS);
+        mutex_unlock(&patron_mutex);
+        return 0;
+    case LEDS_IOC_PARAR:
+        parar_patron();
+        return 0;
+    default:
+        return -ENOTTY;
+    }
+}
+
+/* /sys/class/misc/leds/estadisticas: estado y retraso de cada paso sobre su plazo */
+static ssize_t estadisticas_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    u64 n, d_tot, d_max;
+    int len;
+
+    /* Las toca el hrtimer sin cerrojo: lectura aproximada */
+    n = READ_ONCE(patron_aplicados);
+    d_tot = READ_ONCE(patron_retraso_total_ns);
+    d_max = READ_ONCE(patron_retraso_max_ns);
+    len = sysfs_emit(buf, "leds=%d mascara=0x%llx\n", nr_gpio_leds, leer_mascara());
+    len += sysfs_emit_at(buf, len, "patron=%s pasos=%llu saltos=%llu", READ_ONCE(patron_activo) ? "activo" : "parado",
+                         n, READ_ONCE(patron_saltos));
+    if (n)
+        len += sysfs_emit_at(buf, len, " jitter_medio_ns=%llu jitter_max_ns=%llu",
+                             div64_u64(d_tot, n), d_max);
+    len += sysfs_emit_at(buf, len, "\n");
+    return len;
+}
+static DEVICE_ATTR_RO(estadisticas);
+
+static struct attribute *leds_attrs[] = {
+    &dev_attr_estadisticas.attr,
+    NULL,
+};
+ATTRIBUTE_GROUPS(leds);
+/*
+ * Con patron_mutex: el patrón se para antes, para que un último paso no
+ * pise la máscara, y dos escrituras no dejan led_value y los LEDs distintos.
+ */
+static void aplicar_mascara(u64 mask)
+{
+    mutex_lock(&patron_mutex);
+    if (patron_pasos)
+        parar_patron_locked();
+    guardar_mascara(mask);
+    set_pi_leds(mask);
+    mutex_unlock(&patron_mutex);
+}
+
+/*
+ * Función de escritura para el dispositivo /dev/leds: la máscara en texto,
+ * en decimal o en hexadecimal con 0x (p. ej. "5" o "0xff00ff00ff")
+ */
 static ssize_t dev_write(struct file* filep, const char* buffer, size_t len, loff_t* offset) {
-    int value;
-    char kbuffer[4];
+    u64 value;
+    char kbuffer[24];
+    unsigned int base;
 
-    if (len > 3) {  // Solo aceptamos hasta un valor de 3 caracteres
+    if (len >= sizeof(kbuffer)) {  // "0x" + 16 dígitos + '\n' sobra
         return -EINVAL;
     }
 
@@ -61,20 +280,34 @@ static ssize_t dev_write(struct file* filep, const char* buffer, size_t len, lof
     
     kbuffer[len] = '\0'; // Añadir terminador nulo para convertir en cadena C
 
-    // Convertir la cadena a un número entero
-    if (kstrtoint(kbuffer, 10, &value) != 0) {
+    // Decimal, o hexadecimal solo con prefijo 0x ("010" es diez, no octal); admite '\n' final
+    base = (kbuffer[0] == '0' && tolower(kbuffer[1]) == 'x') ? 16 : 10;
+    if (kstrtou64(kbuffer, base, &value) != 0) {
         return -EINVAL;
     }
 
-    // Verificar si el valor está en el rango 0-7
-    if (value < MIN_LED_VALUE || value > MAX_LED_VALUE) {
+    // Verificar que no hay bits fuera de los LEDs configurados
+    if (!mascara_valida(value)) {
         return -EINVAL;
     }
 
-    led_value = value;
+    aplicar_mascara(value);
+
+    return len;
+}
+
+/* Escritura para /dev/leds_bin: exactamente un u64 en el orden de bytes nativo */
+static ssize_t dev_write_bin(struct file* filep, const char* buffer, size_t len, loff_t* offset) {
+    u64 value;
 
-    set_pi_leds(led_value);
+    if (len != sizeof(value))
+        return -EINVAL;
+    if (copy_from_user(&value, buffer, sizeof(value)))
+        return -EFAULT;
+    if (!mascara_valida(value))
+        return -EINVAL;
 
+    aplicar_mascara(value);
     return len;
 }
 
@@ -87,13 +320,23 @@ static int __init leds_init(void) {
     int err = 0;
     char gpio_str[10];
 
+    hrtimer_init(&patron_timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+    patron_timer.function = patron_fn;
+
     ret = misc_register(&misc_leds);
     if (ret) {
         pr_err("No se puede registrar misc_leds\n");
         return ret;
     }
 
-    for (i = 0; i < NR_GPIO_LEDS; i++) {
+    ret = misc_register(&misc_leds_bin);
+    if (ret) {
+        pr_err("No se puede registrar misc_leds_bin\n");
+        misc_deregister(&misc_leds);
+        return ret;
+    }
+
+    for (i = 0; i < nr_gpio_leds; i++) {
         sprintf(gpio_str, "led_%d", i);
 
          if ((err = gpio_request(led_gpio[i], gpio_str))) {
@@ -111,13 +354,14 @@ static int __init leds_init(void) {
         gpiod_direction_output(gpio_descriptors[i], 0);
     }
 
-    pr_info("LED device registered\n");
+    pr_info("LED device registered (%d LEDs)\n", nr_gpio_leds);
     return 0;
 
 err_handle:
     while (i--) {
         gpio_free(led_gpio[i]);
     }
+    misc_deregister(&misc_leds_bin);
     misc_deregister(&misc_leds);
     return err;
 }
@@ -127,11 +371,13 @@ static void __exit leds_exit(void)
 {
     int i;
 
+    misc_deregister(&misc_leds_bin);
+    misc_deregister(&misc_leds);
+    parar_patron();
     set_pi_leds(MIN_LED_VALUE);
-    for (i = 0; i < NR_GPIO_LEDS; i++) {
+    for (i = 0; i < nr_gpio_leds; i++) {
         gpiod_put(gpio_descriptors[i]);
     }
-    misc_deregister(&misc_leds);
     pr_info("LED device unregistered\n");
 
 }
@@ -141,5 +387,5 @@ module_exit(leds_exit);
 
 MODULE_LICENSE("GPL"); 
 MODULE_AUTHOR("Lucas Calzada Y Juan Girón"); 
-MODULE_DESCRIPTION("Driver de dispositivo de caracteres para controlar los LEDs D1-D3 de la placa Bee");
+MODULE_DESCRIPTION("Driver de dispositivo de caracteres para controlar los LEDs D1-D3 de la placa Bee (o hasta 64 GPIOs)");
 
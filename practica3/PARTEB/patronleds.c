@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include "leds.h"
+
+/*
+ * Compara el jitter de un patrón de LEDs temporizado por el kernel (ioctl
+ * LEDS_IOC_PATRON, un hrtimer aplica los pasos) con el mismo patrón
+ * temporizado desde usuario (clock_nanosleep absoluto + write() por paso,
+ * como contador.sh pero sin procesos ni deriva acumulada).
+ * El jitter es el retraso de cada paso respecto a su plazo ideal.
+ *
+ * Uso: ./patronleds <kernel|usuario> [num_pasos] [periodo_us]
+ */
+#define NS_POR_S 1000000000LL
+
+static int num_pasos = 1000;
+static long periodo_us = 1000;
+
+static int64_t ahora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NS_POR_S + ts.tv_nsec;
+}
+
+static int patron_kernel(int fd) {
+    struct leds_paso *pasos = calloc(num_pasos, sizeof(*pasos));
+    struct leds_patron p;
+    char linea[256];
+    FILE *f;
+
+    if (!pasos)
+        return -1;
+    for (int i = 0; i < num_pasos; i++) {
+        pasos[i].mascara = i % 8; // Contador binario en D1-D3
+        pasos[i].duracion_us = periodo_us;
+    }
+
+    p.pasos = (uintptr_t)pasos;
+    p.num_pasos = num_pasos;
+    p.repeticiones = 1;
+    if (ioctl(fd, LEDS_IOC_PATRON, &p) == -1) {
+        perror("ioctl");
+        return -1;
+    }
+    usleep(num_pasos * periodo_us + 100000);
+
+    f = fopen("/sys/class/misc/leds/estadisticas", "r");
+    while (f && fgets(linea, sizeof(linea), f))
+        if (strncmp(linea, "patron=", 7) == 0)
+            printf("kernel: %s", linea);
+    if (f)
+        fclose(f);
+    free(pasos);
+    return 0;
+}
+
+static int patron_usuario(int fd) {
+    struct timespec plazo;
+    int64_t inicio = ahora_ns() + periodo_us * 1000;
+    int64_t objetivo, retraso, total = 0, max = 0;
+    char buffer[3];
+
+    for (int i = 0; i < num_pasos; i++) {
+        objetivo = inicio + (int64_t)i * periodo_us * 1000;
+        plazo.tv_sec = objetivo / NS_POR_S;
+        plazo.tv_nsec = objetivo % NS_POR_S;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &plazo, NULL);
+
+        snprintf(buffer, sizeof(buffer), "%d", i % 8);
+        if (write(fd, buffer, 1) == -1) {
+            perror("Error al escribir en el dispositivo");
+            return -1;
+        }
+        /* El paso se aplica al volver de write() */
+        retraso = ahora_ns() - objetivo;
+        total += retraso;
+        if (retraso > max)
+            max = retraso;
+    }
+
+    printf("usuario: pasos=%d jitter_medio_ns=%lld jitter_max_ns=%lld\n",
+           num_pasos, (long long)(total / num_pasos), (long long)max);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int fd, ret;
+
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <kernel|usuario> [num_pasos] [periodo_us]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (argc > 2)
+        num_pasos = atoi(argv[2]);
+    if (argc > 3)
+        periodo_us = atol(argv[3]);
+    if (num_pasos < 1 || num_pasos > LEDS_MAX_PASOS || periodo_us < LEDS_MIN_DURACION_US) {
+        fprintf(stderr, "num_pasos entre 1 y %d, periodo_us >= %d\n", LEDS_MAX_PASOS,
+                LEDS_MIN_DURACION_US);
+        return EXIT_FAILURE;
+    }
+
+    fd = open("/dev/leds", O_WRONLY);
+    if (fd == -1) {
+        perror("Error al abrir el dispositivo");
+        return EXIT_FAILURE;
+    }
+
+    if (strcmp(argv[1], "kernel") == 0)
+        ret = patron_kernel(fd);
+    else if (strcmp(argv[1], "usuario") == 0)
+        ret = patron_usuario(fd);
+    else {
+        fprintf(stderr, "Modo desconocido: %s\n", argv[1]);
+        ret = -1;
+    }
+
+    close(fd);
+    return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
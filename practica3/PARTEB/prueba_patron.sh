@@ -0,0 +1,31 @@
+#!/bin/bash
+
+# Jitter de los patrones de /dev/leds sobre un chip GPIO simulado: el mismo
+# contador binario temporizado por el hrtimer del driver y desde usuario.
+# Comprueba además que el patrón del kernel aplica todos sus pasos.
+# Uso (como root, desde este directorio): ./prueba_patron.sh [num_pasos] [periodo_us]
+
+source ../TestBee/gpio_simulado.sh
+
+PASOS=${1:-2000}
+PERIODO_US=${2:-500}
+ESTADISTICAS=/sys/class/misc/leds/estadisticas
+
+make -s patronleds || exit 1
+
+base=$(gpio_simulado_crear 3) || exit 1
+rmmod ledspi 2>/dev/null
+insmod ledspi.ko led_gpio=$(gpio_simulado_lineas $base 3) || exit 1
+
+./patronleds kernel $PASOS $PERIODO_US
+aplicados=$(grep -o "pasos=[0-9]*" $ESTADISTICAS | cut -d= -f2)
+./patronleds usuario $PASOS $PERIODO_US
+
+rmmod ledspi
+gpio_simulado_destruir
+
+if [ "$aplicados" != "$PASOS" ]; then
+    echo "FALLO: el kernel aplicó $aplicados pasos, se esperaban $PASOS"
+    exit 1
+fi
+echo "OK"
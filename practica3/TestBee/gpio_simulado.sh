@@ -0,0 +1,31 @@
+#!/bin/bash
+#
+# Funciones para probar los drivers sin la placa Bee, sobre un chip GPIO
+# simulado (gpio-mockup). Se usa gpio-mockup y no gpio-sim porque sus
+# líneas no duermen y pueden manejarse desde hrtimers e interrupciones.
+#
+# Uso: source gpio_simulado.sh; base=$(gpio_simulado_crear 8)
+
+# Crea un chip simulado de N líneas e imprime su número de GPIO base
+gpio_simulado_crear() {
+    local n=${1:-8}
+
+    modprobe -r gpio-mockup 2>/dev/null
+    modprobe gpio-mockup gpio_mockup_ranges=-1,$n || return 1
+    mountpoint -q /sys/kernel/debug || mount -t debugfs none /sys/kernel/debug
+    grep -m1 "gpio-mockup-A" /sys/kernel/debug/gpio | sed 's/.*GPIOs \([0-9]*\)-.*/\1/'
+}
+
+# Lista "a,b,c" con las n líneas consecutivas a partir de base
+gpio_simulado_lineas() {
+    seq -s, $1 $(( $1 + $2 - 1 ))
+}
+
+# Fuerza el valor de entrada de la línea `offset` (0/1) del chip simulado
+gpio_simulado_poner() {
+    echo $2 > /sys/kernel/debug/gpio-mockup/gpiochip*/$1
+}
+
+gpio_simulado_destruir() {
+    modprobe -r gpio-mockup
+}
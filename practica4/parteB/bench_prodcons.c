@@ -0,0 +1,206 @@
+/*
+ * bench_prodcons.c
+ *
+ * Compara el camino read/write de /dev/prodcons con el anillo compartido
+ * (mmap). Un hilo produce y otro consume N enteros; se informa de
+ * elementos/segundo y tiempo de CPU (usuario + sistema) por elemento.
+ *
+ * Uso: ./bench_prodcons <rw|mmap> [num_elementos]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include "prodcons.h"
+
+#define DEVICE_PATH "/dev/prodcons"
+
+static int fd;
+static long num_elementos = 100000;
+static struct prodcons_shm_ctl *ctl;
+static int *datos;
+static long errores = 0;
+
+static double ahora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double cpu_total(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 +
+           ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+/* Camino clásico: una llamada al sistema por elemento */
+static void *productor_rw(void *arg) {
+    char buf[16];
+    long i;
+
+    for (i = 0; i < num_elementos; i++) {
+        int len = snprintf(buf, sizeof(buf), "%ld\n", i);
+        if (write(fd, buf, len) != len) {
+            perror("write");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return NULL;
+}
+
+static void *consumidor_rw(void *arg) {
+    char buf[16];
+    long i;
+
+    for (i = 0; i < num_elementos; i++) {
+        ssize_t len = pread(fd, buf, sizeof(buf) - 1, 0);
+        if (len <= 0) {
+            perror("read");
+            exit(EXIT_FAILURE);
+        }
+        buf[len] = '\0';
+        if (atol(buf) != i)
+            errores++;
+    }
+    return NULL;
+}
+
+/* Anillo compartido: solo se entra al kernel en las transiciones vacío/lleno */
+static void producir_shm(int valor) {
+    uint32_t cabeza = ctl->cabeza;
+    uint32_t capacidad = ctl->capacidad;
+
+    while (cabeza - __atomic_load_n(&ctl->cola, __ATOMIC_ACQUIRE) == capacidad) {
+        __atomic_store_n(&ctl->esperando_huecos, 1, __ATOMIC_SEQ_CST);
+        if (cabeza - __atomic_load_n(&ctl->cola, __ATOMIC_SEQ_CST) == capacidad)
+            ioctl(fd, PRODCONS_IOC_ESPERAR_HUECOS);
+        __atomic_store_n(&ctl->esperando_huecos, 0, __ATOMIC_RELAXED);
+    }
+
+    datos[cabeza & (capacidad - 1)] = valor;
+    __atomic_store_n(&ctl->cabeza, cabeza + 1, __ATOMIC_RELEASE);
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ctl->esperando_elementos, __ATOMIC_RELAXED))
+        ioctl(fd, PRODCONS_IOC_DESPERTAR);
+}
+
+static int consumir_shm(void) {
+    uint32_t cola = ctl->cola;
+    uint32_t capacidad = ctl->capacidad;
+    int valor;
+
+    while (__atomic_load_n(&ctl->cabeza, __ATOMIC_ACQUIRE) == cola) {
+        __atomic_store_n(&ctl->esperando_elementos, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&ctl->cabeza, __ATOMIC_SEQ_CST) == cola)
+            ioctl(fd, PRODCONS_IOC_ESPERAR_ELEMENTOS);
+        __atomic_store_n(&ctl->esperando_elementos, 0, __ATOMIC_RELAXED);
+    }
+
+    valor = datos[cola & (capacidad - 1)];
+    __atomic_store_n(&ctl->cola, cola + 1, __ATOMIC_RELEASE);
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ctl->esperando_huecos, __ATOMIC_RELAXED))
+        ioctl(fd, PRODCONS_IOC_DESPERTAR);
+
+    return valor;
+}
+
+static void *productor_shm(void *arg) {
+    long i;
+
+    for (i = 0; i < num_elementos; i++)
+        producir_shm((int)i);
+    return NULL;
+}
+
+static void *consumidor_shm(void *arg) {
+    long i;
+
+    for (i = 0; i < num_elementos; i++)
+        if (consumir_shm() != (int)i)
+            errores++;
+    return NULL;
+}
+
+static int mapear_anillo(void) {
+    struct prodcons_shm_ctl *c;
+    size_t tam;
+    void *area;
+
+    /* Primero solo la página de control para conocer la capacidad */
+    c = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, fd, 0);
+    if (c == MAP_FAILED)
+        return -1;
+    tam = c->offset_datos + (size_t)c->capacidad * sizeof(int);
+    munmap(c, sysconf(_SC_PAGESIZE));
+
+    area = mmap(NULL, tam, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (area == MAP_FAILED)
+        return -1;
+
+    ctl = area;
+    datos = (int *)((char *)area + ctl->offset_datos);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    pthread_t prod, cons;
+    void *(*fprod)(void *), *(*fcons)(void *);
+    double t0, t1, c0, c1;
+
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <rw|mmap> [num_elementos]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (argc > 2)
+        num_elementos = atol(argv[2]);
+
+    fd = open(DEVICE_PATH, O_RDWR);
+    if (fd == -1) {
+        perror("Error al abrir el dispositivo");
+        return EXIT_FAILURE;
+    }
+
+    if (strcmp(argv[1], "rw") == 0) {
+        fprod = productor_rw;
+        fcons = consumidor_rw;
+    } else if (strcmp(argv[1], "mmap") == 0) {
+        if (mapear_anillo()) {
+            perror("mmap");
+            return EXIT_FAILURE;
+        }
+        fprod = productor_shm;
+        fcons = consumidor_shm;
+    } else {
+        fprintf(stderr, "Modo desconocido: %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    t0 = ahora();
+    c0 = cpu_total();
+
+    pthread_create(&cons, NULL, fcons, NULL);
+    pthread_create(&prod, NULL, fprod, NULL);
+    pthread_join(prod, NULL);
+    pthread_join(cons, NULL);
+
+    t1 = ahora();
+    c1 = cpu_total();
+
+    printf("modo=%s elementos=%ld errores=%ld\n", argv[1], num_elementos, errores);
+    printf("  %.0f elementos/s\n", num_elementos / (t1 - t0));
+    printf("  %.1f ns de CPU por elemento\n", (c1 - c0) * 1e9 / num_elementos);
+
+    close(fd);
+    return errores ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -10,39 +10,473 @@
 #include <asm/uaccess.h>
 #include <asm/errno.h>
 #include <linux/kfifo.h>
+#include <linux/vmalloc.h>
+#include <linux/mm.h>
+#include <linux/wait.h>
+#include <linux/log2.h>
+#include <linux/ktime.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/percpu.h>
+#include <linux/jump_label.h>
+#include <linux/slab.h>
+#include <linux/workqueue.h>
+#include <linux/fs.h>
+#include "prodcons.h"
 
 MODULE_LICENSE("GPL");
 MODULE_AUTHOR("Juan y Lucas");
 MODULE_DESCRIPTION("Módulo ProdCons con buffer circular y semáforos");
 
 #define DEVICE_NAME "prodcons"
-#define BUFFER_SIZE 4 // Tamaño máximo del buffer en enteros (4 enteros x 4 bytes)
+#define BUFFER_SIZE 4 // Tamaño máximo de cada carril en elementos
 
-static struct kfifo fifo_buffer;
+static int shm_paginas = 16;
+module_param(shm_paginas, int, 0444);
+MODULE_PARM_DESC(shm_paginas, "Páginas de datos del anillo compartido (potencia de 2)");
 
-struct semaphore elementos,huecos, mtx;
+static int cuota_baja = 0;
+module_param(cuota_baja, int, 0644);
+MODULE_PARM_DESC(cuota_baja, "Extracciones seguidas de carriles altos antes de atender uno bajo (0 = sin cuota)");
 
-static DEFINE_SPINLOCK(spin_count);   // Protección para contador de referencias
-static int contador_referencias = 0;          // Contador de referencias
+/*
+ * Carriles de prioridad: cada escritura elige carril con el formato
+ * "[prioridad:]num" (0 = menor prioridad, por defecto). Los consumidores
+ * vacían siempre primero el carril más alto con elementos.
+ */
+#define NUM_CARRILES PRODCONS_NUM_CARRILES
+#define NUM_CUBETAS 32 // Cubetas log2 de los histogramas (ns)
 
+struct elemento {
+    int num;
+    u64 t_encolado; // ktime_get_ns() al insertar
+};
+
+struct carril {
+    struct kfifo fifo;
+    struct semaphore huecos;
+};
+
+static struct carril carriles[NUM_CARRILES];
+static int seguidos_altos = 0; // Extracciones seguidas saltándose carriles bajos
+
+struct semaphore elementos;
+
+/*
+ * Los buffers se protegen con un spinlock (y no con un semáforo) para que
+ * prodcons_encolar_atomico() pueda usarse desde interrupciones y timers.
+ */
+static DEFINE_SPINLOCK(fifo_lock);
+
+/*
+ * Instrumentación: contadores e histogramas log2 por CPU, visibles en
+ * /sys/kernel/debug/prodcons/. Los histogramas de latencia por carril se
+ * llenan siempre; el resto solo con la clave estática activada
+ * (echo 1 > .../activar). Apagada, cada punto de medida se reduce a un
+ * salto no tomado.
+ */
+static DEFINE_STATIC_KEY_FALSE(instrumentacion);
+
+struct prodcons_stats {
+    u64 encolados;
+    u64 desencolados;
+    u64 descartados;        // Inserciones atómicas perdidas por buffer lleno
+    u64 sobrescritos;       // Elementos antiguos reemplazados por buffer lleno
+    u64 bloqueos_huecos;    // Productores que durmieron en `huecos`
+    u64 bloqueos_elementos; // Consumidores que durmieron en `elementos`
+    u64 lat_carril[NUM_CARRILES][NUM_CUBETAS]; // Encolado -> extracción (siempre)
+    u64 espera_huecos[NUM_CUBETAS];
+    u64 espera_elementos[NUM_CUBETAS];
+    u64 cerrojo[NUM_CUBETAS];                  // Tiempo con fifo_lock tomado
+};
+static DEFINE_PER_CPU(struct prodcons_stats, stats);
+
+/* Semáforo en el que se mide una espera */
+enum {
+    PRODCONS_ESPERA_HUECOS,
+    PRODCONS_ESPERA_ELEMENTOS
+};
+
+#define CREATE_TRACE_POINTS
+#include "prodcons_trace.h"
+
+static inline bool instrumentacion_activa(void) {
+    return static_branch_unlikely(&instrumentacion);
+}
+
+static inline int cubeta(u64 ns) {
+    return min(ns ? ilog2(ns) : 0, NUM_CUBETAS - 1);
+}
+
+/* Toma fifo_lock; devuelve la marca de tiempo para medir el tiempo de retención */
+static inline u64 tomar_cerrojo(unsigned long *flags) {
+    spin_lock_irqsave(&fifo_lock, *flags);
+    return instrumentacion_activa() ? ktime_get_ns() : 0;
+}
+
+static inline void soltar_cerrojo(unsigned long flags, u64 t0) {
+    if (t0)
+        this_cpu_inc(stats.cerrojo[cubeta(ktime_get_ns() - t0)]);
+    spin_unlock_irqrestore(&fifo_lock, flags);
+}
+
+/* down_interruptible() que mide el tiempo dormido en el semáforo */
+static int esperar_semaforo(struct semaphore *sem, int espera) {
+    u64 t0, dt;
+
+    if (!instrumentacion_activa() && !trace_prodcons_espera_enabled())
+        return down_interruptible(sem);
+
+    if (!down_trylock(sem))
+        return 0;
+
+    t0 = ktime_get_ns();
+    if (down_interruptible(sem))
+        return -EINTR;
+    dt = ktime_get_ns() - t0;
+
+    trace_prodcons_espera(espera, dt);
+    if (espera == PRODCONS_ESPERA_HUECOS) {
+        this_cpu_inc(stats.bloqueos_huecos);
+        this_cpu_inc(stats.espera_huecos[cubeta(dt)]);
+    } else {
+        this_cpu_inc(stats.bloqueos_elementos);
+        this_cpu_inc(stats.espera_elementos[cubeta(dt)]);
+    }
+    return 0;
+}
+
+/*
+ * Drenado para descargas controladas: se deja de aceptar productores, los
+ * consumidores vacían el buffer hasta el plazo y lo que quede se vuelca.
+ */
+enum {
+    PRODCONS_ACTIVO,   // Funcionamiento normal
+    PRODCONS_DRENANDO, // Se rechazan productores; los consumidores vacían
+    PRODCONS_CERRADO   // Plazo vencido: todas las operaciones fallan
+};
+static int estado = PRODCONS_ACTIVO;
+static unsigned int plazo_drenado_ms = 0;
+static bool modulo_listo = false;
+static void cerrar_prodcons(struct work_struct *work);
+static DECLARE_DELAYED_WORK(fin_drenado, cerrar_prodcons);
+
+static char *volcado = NULL;
+module_param(volcado, charp, 0644);
+MODULE_PARM_DESC(volcado, "Fichero en el que volcar los elementos que queden al cerrar");
 
-// Inserta un número en el buffer
-static void insertar_entero(int num) {
+/* Anillo compartido con espacio de usuario (mmap) */
+static void *shm_area;                        // Página de control + páginas de datos
+static struct prodcons_shm_ctl *shm_ctl;
+static DECLARE_WAIT_QUEUE_HEAD(shm_espera_elementos);
+static DECLARE_WAIT_QUEUE_HEAD(shm_espera_huecos);
 
-    kfifo_in(&fifo_buffer, &num, sizeof(int));
+static struct dentry *debugfs_dir;
+
+
+// Inserta un número en el carril indicado
+static void insertar_entero(int num, int prio) {
+    struct elemento e = { .num = num, .t_encolado = ktime_get_ns() };
+
+    if (instrumentacion_activa())
+        this_cpu_inc(stats.encolados);
+
+    kfifo_in(&carriles[prio].fifo, &e, sizeof(e));
+    trace_prodcons_encolar(num, prio, kfifo_len(&carriles[prio].fifo) / sizeof(e));
 }
 
-// Extrae un número del buffer
-static int extraer_entero(void) {
-    int num, ret;
-    ret = kfifo_out(&fifo_buffer, &num, sizeof(int));
-    return num;
+// Elige el carril a atender respetando la cuota anti-inanición
+static int elegir_carril(void) {
+    int prio, alto = -1, bajo = -1;
+
+    for (prio = NUM_CARRILES - 1; prio >= 0; prio--) {
+        if (kfifo_is_empty(&carriles[prio].fifo))
+            continue;
+        if (alto < 0)
+            alto = prio;
+        bajo = prio;
+    }
+
+    if (alto != bajo && cuota_baja > 0 && ++seguidos_altos > cuota_baja) {
+        seguidos_altos = 0;
+        return bajo;
+    }
+    if (alto == bajo)
+        seguidos_altos = 0;
+
+    return alto;
 }
 
+// Extrae un número del carril más prioritario; devuelve el carril usado o -1 si no hay
+static int extraer_entero(int *num) {
+    struct elemento e;
+    int prio;
+    u64 lat;
+
+    prio = elegir_carril();
+    if (prio < 0 || kfifo_out(&carriles[prio].fifo, &e, sizeof(e)) != sizeof(e))
+        return -1;
+
+    lat = ktime_get_ns() - e.t_encolado;
+    this_cpu_inc(stats.lat_carril[prio][cubeta(lat)]);
+    if (instrumentacion_activa())
+        this_cpu_inc(stats.desencolados);
+    trace_prodcons_desencolar(e.num, prio, lat);
+
+    *num = e.num;
+    return prio;
+}
+
+static inline bool aceptando(void) {
+    return READ_ONCE(estado) == PRODCONS_ACTIVO;
+}
+
+// ¿Están vacíos todos los carriles? (con fifo_lock tomado)
+static bool carriles_vacios(void) {
+    int prio;
+
+    for (prio = 0; prio < NUM_CARRILES; prio++)
+        if (!kfifo_is_empty(&carriles[prio].fifo))
+            return false;
+    return true;
+}
+
+/*
+ * API interna: inserción bloqueante. Duerme si el carril está lleno.
+ * Devuelve -ESHUTDOWN si el dispositivo se está drenando.
+ */
+int prodcons_encolar(int num, int prio) {
+    unsigned long flags;
+    u64 t;
+
+    if (prio < 0 || prio >= NUM_CARRILES)
+        return -EINVAL;
+
+    if (!aceptando())
+        return -ESHUTDOWN;
+
+    if (esperar_semaforo(&carriles[prio].huecos, PRODCONS_ESPERA_HUECOS))
+        return -EINTR;
+
+    /* Entrar a la SC */
+    t = tomar_cerrojo(&flags);
+    if (!aceptando()) {
+        soltar_cerrojo(flags, t);
+        up(&carriles[prio].huecos); // Pasar el testigo al siguiente productor dormido
+        return -ESHUTDOWN;
+    }
+    insertar_entero(num, prio);
+    /* Salir de la SC */
+    soltar_cerrojo(flags, t);
+
+    up(&elementos);
+    return 0;
+}
+EXPORT_SYMBOL_GPL(prodcons_encolar);
+
+/*
+ * API interna: inserción que nunca duerme, usable desde contexto atómico
+ * (manejadores de IRQ, timers). Si el carril está lleno se descarta el
+ * elemento nuevo o se sobrescribe el más antiguo según la política.
+ */
+int prodcons_encolar_atomico(int num, int prio, enum prodcons_politica politica) {
+    struct elemento viejo;
+    unsigned long flags;
+    int ret = 0;
+    u64 t;
+
+    if (prio < 0 || prio >= NUM_CARRILES)
+        return -EINVAL;
+
+    if (!aceptando())
+        return -ESHUTDOWN;
+
+    if (!down_trylock(&carriles[prio].huecos)) {
+        t = tomar_cerrojo(&flags);
+        if (!aceptando()) {
+            soltar_cerrojo(flags, t);
+            up(&carriles[prio].huecos);
+            return -ESHUTDOWN;
+        }
+        insertar_entero(num, prio);
+        soltar_cerrojo(flags, t);
+        up(&elementos);
+        return 0;
+    }
+
+    t = tomar_cerrojo(&flags);
+    /*
+     * Sobrescribir solo si hay un elemento que sacar: los huecos reservados
+     * por productores dormidos no se pueden ocupar.
+     */
+    if (!aceptando()) {
+        ret = -ESHUTDOWN;
+    } else if (politica == PRODCONS_SOBRESCRIBIR &&
+        kfifo_out(&carriles[prio].fifo, &viejo, sizeof(viejo)) == sizeof(viejo)) {
+        insertar_entero(num, prio);
+        this_cpu_inc(stats.sobrescritos);
+    } else {
+        this_cpu_inc(stats.descartados);
+        ret = -ENOSPC;
+    }
+    soltar_cerrojo(flags, t);
+
+    return ret;
+}
+EXPORT_SYMBOL_GPL(prodcons_encolar_atomico);
+
+/*
+ * API interna: extracción bloqueante del carril más prioritario.
+ * Durante el drenado se siguen entregando elementos; una vez vacío el
+ * buffer devuelve -ESHUTDOWN en lugar de dormir.
+ */
+int prodcons_desencolar(int *num) {
+    unsigned long flags;
+    bool agotado;
+    int prio;
+    u64 t;
+
+    if (esperar_semaforo(&elementos, PRODCONS_ESPERA_ELEMENTOS))
+        return -EINTR;
+
+    /* Entrar a la SC */
+    t = tomar_cerrojo(&flags);
+    prio = extraer_entero(num);
+    agotado = !aceptando() && carriles_vacios();
+    /* Salir de la SC */
+    soltar_cerrojo(flags, t);
+
+    if (prio < 0) {
+        /* Testigo de drenado: no hay elemento, despertar al siguiente consumidor */
+        up(&elementos);
+        return -ESHUTDOWN;
+    }
+
+    up(&carriles[prio].huecos);
+    if (agotado)
+        up(&elementos); // Último elemento del drenado: despertar a los que esperan
+    return 0;
+}
+EXPORT_SYMBOL_GPL(prodcons_desencolar);
+
+/*
+ * Saca los elementos que queden en los carriles y, si se configuró el
+ * parámetro `volcado`, los añade a ese fichero con el formato de escritura
+ * "prioridad:num" para poder reinyectarlos tras la actualización.
+ */
+static void volcar_restantes(void) {
+    struct {
+        int prio;
+        struct elemento e;
+    } restantes[NUM_CARRILES * BUFFER_SIZE];
+    struct file *filp;
+    unsigned long flags;
+    char buf[24];
+    int n = 0, i, prio, len;
+
+    spin_lock_irqsave(&fifo_lock, flags);
+    for (prio = NUM_CARRILES - 1; prio >= 0; prio--)
+        while (n < ARRAY_SIZE(restantes) &&
+               kfifo_out(&carriles[prio].fifo, &restantes[n].e,
+                         sizeof(struct elemento)) == sizeof(struct elemento))
+            restantes[n++].prio = prio;
+    spin_unlock_irqrestore(&fifo_lock, flags);
+
+    if (n == 0)
+        return;
+
+    if (!volcado || !*volcado) {
+        pr_warn("ProdCons: %d elementos descartados al cerrar\n", n);
+        return;
+    }
+
+    filp = filp_open(volcado, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (IS_ERR(filp)) {
+        pr_err("ProdCons: no se puede abrir %s, %d elementos perdidos\n", volcado, n);
+        return;
+    }
+
+    for (i = 0; i < n; i++) {
+        len = snprintf(buf, sizeof(buf), "%d:%d\n", restantes[i].prio, restantes[i].e.num);
+        kernel_write(filp, buf, len, &filp->f_pos);
+    }
+    filp_close(filp, NULL);
+
+    pr_info("ProdCons: %d elementos volcados en %s\n", n, volcado);
+}
+
+// Vence el plazo de drenado: se cierra el dispositivo y se vuelca lo que quede
+static void cerrar_prodcons(struct work_struct *work) {
+    unsigned long flags;
+
+    spin_lock_irqsave(&fifo_lock, flags);
+    WRITE_ONCE(estado, PRODCONS_CERRADO);
+    spin_unlock_irqrestore(&fifo_lock, flags);
+
+    volcar_restantes();
+
+    up(&elementos);
+    wake_up_interruptible(&shm_espera_elementos);
+    wake_up_interruptible(&shm_espera_huecos);
+
+    pr_info("ProdCons: dispositivo cerrado\n");
+}
+
+/*
+ * Inicia el drenado: se rechazan los productores (-ESHUTDOWN), los
+ * consumidores vacían el buffer y, pasado el plazo, se cierra el dispositivo.
+ * Los procesos dormidos en un semáforo se despiertan en cadena: cada uno
+ * devuelve el testigo con up() antes de salir con error.
+ */
+static void iniciar_drenado(unsigned int plazo_ms) {
+    unsigned long flags;
+    bool vacio;
+    int prio;
+
+    spin_lock_irqsave(&fifo_lock, flags);
+    if (!aceptando()) {
+        spin_unlock_irqrestore(&fifo_lock, flags);
+        return;
+    }
+    WRITE_ONCE(estado, PRODCONS_DRENANDO);
+    vacio = carriles_vacios();
+    spin_unlock_irqrestore(&fifo_lock, flags);
+
+    pr_info("ProdCons: drenando (plazo de %u ms)\n", plazo_ms);
+
+    for (prio = 0; prio < NUM_CARRILES; prio++)
+        up(&carriles[prio].huecos);
+    if (vacio)
+        up(&elementos);
+    wake_up_interruptible(&shm_espera_elementos);
+    wake_up_interruptible(&shm_espera_huecos);
+
+    schedule_delayed_work(&fin_drenado, msecs_to_jiffies(plazo_ms));
+}
+
+/* echo <plazo_ms> > /sys/module/prodcons/parameters/drenar */
+static int drenar_set(const char *val, const struct kernel_param *kp) {
+    int ret = param_set_uint(val, kp);
+
+    if (ret == 0 && modulo_listo)
+        iniciar_drenado(plazo_drenado_ms);
+    return ret;
+}
+
+static const struct kernel_param_ops drenar_ops = {
+    .set = drenar_set,
+    .get = param_get_uint,
+};
+module_param_cb(drenar, &drenar_ops, &plazo_drenado_ms, 0644);
+MODULE_PARM_DESC(drenar, "Escribir un plazo en ms inicia el drenado del dispositivo");
+
 // Operación de escritura (inserción en el buffer)
 static ssize_t prodcons_write(struct file *file, const char __user *ubuf, size_t count, loff_t *ppos) {
     char kbuf[16];
-    int num;
+    char *valor = kbuf;
+    char *sep;
+    int num, prio = 0;
+    int ret;
 
     if (count > sizeof(kbuf) - 1)
         return -EINVAL;
@@ -52,23 +486,19 @@ static ssize_t prodcons_write(struct file *file, const char __user *ubuf, size_t
 
     kbuf[count] = '\0';
 
-    if (kstrtoint(kbuf, 10, &num) != 0)
-        return -EINVAL;
-
-    if (down_interruptible(&huecos))
-        return -EINTR;
-
-    /* Entrar a la SC */
-    if (down_interruptible(&mtx)) {
-    up(&huecos);
-    return -EINTR;
+    // Prefijo opcional "prioridad:"
+    if ((sep = strchr(kbuf, ':'))) {
+        *sep = '\0';
+        valor = sep + 1;
+        if (kstrtoint(kbuf, 10, &prio) != 0 || prio < 0 || prio >= NUM_CARRILES)
+            return -EINVAL;
     }
 
-    insertar_entero(num);
+    if (kstrtoint(valor, 10, &num) != 0)
+        return -EINVAL;
 
-    /* Salir de la SC */
-    up(&mtx);
-    up(&elementos);
+    if ((ret = prodcons_encolar(num, prio)))
+        return ret;
 
     return count;
 }
@@ -78,29 +508,13 @@ static ssize_t prodcons_read(struct file *file, char __user *ubuf, size_t count,
     int num;
     char kbuf[16];
     int len;
+    int ret;
 
     if ((*ppos) > 0) /* Tell the application that there is nothing left to read */
         return 0;
 
-    /*if(kfifo_is_empty(&fifo_buffer))
-    {
-        return 0;
-    }*/
-
-    if (down_interruptible(&elementos))
-        return -EINTR;
-
-    /* Entrar a la SC */
-    if (down_interruptible(&mtx)){
-        up(&elementos);
-        return -EINTR;
-    }
-
-    num = extraer_entero();
-
-    /* Salir de la SC */
-    up(&mtx);
-    up(&huecos);
+    if ((ret = prodcons_desencolar(&num)))
+        return ret;
 
     len = snprintf(kbuf, sizeof(kbuf), "%d\n", num);
     if (copy_to_user(ubuf, kbuf, len))
@@ -111,24 +525,158 @@ static ssize_t prodcons_read(struct file *file, char __user *ubuf, size_t count,
     return len;
 }
 
-// Operación open para controlar procesos
-static int prodcons_open(struct inode *inode, struct file *file) {
-    if (!try_module_get(THIS_MODULE))  // Incrementa contador de referencia
-        return -EBUSY;
+/* Suma de las estadísticas de todas las CPUs */
+static void sumar_stats(struct prodcons_stats *total) {
+    int cpu, i, j;
+
+    memset(total, 0, sizeof(*total));
+    for_each_possible_cpu(cpu) {
+        struct prodcons_stats *s = per_cpu_ptr(&stats, cpu);
+
+        total->encolados += s->encolados;
+        total->desencolados += s->desencolados;
+        total->descartados += s->descartados;
+        total->sobrescritos += s->sobrescritos;
+        total->bloqueos_huecos += s->bloqueos_huecos;
+        total->bloqueos_elementos += s->bloqueos_elementos;
+        for (i = 0; i < NUM_CUBETAS; i++) {
+            for (j = 0; j < NUM_CARRILES; j++)
+                total->lat_carril[j][i] += s->lat_carril[j][i];
+            total->espera_huecos[i] += s->espera_huecos[i];
+            total->espera_elementos[i] += s->espera_elementos[i];
+            total->cerrojo[i] += s->cerrojo[i];
+        }
+    }
+}
 
-    spin_lock(&spin_count);
-    contador_referencias++;
-    spin_unlock(&spin_count);
+static void mostrar_histograma(struct seq_file *m, const char *nombre, const u64 *h) {
+    int i;
+
+    seq_printf(m, "%s:\n", nombre);
+    for (i = 0; i < NUM_CUBETAS; i++)
+        if (h[i])
+            seq_printf(m, "  [%llu, %llu) ns: %llu\n", 1ULL << i, 1ULL << (i + 1), h[i]);
+}
+
+// Ocupación e histogramas de latencia por carril: /sys/kernel/debug/prodcons/carriles
+static int carriles_show(struct seq_file *m, void *v) {
+    struct prodcons_stats *total;
+    unsigned int ocupacion[NUM_CARRILES];
+    char nombre[16];
+    int prio;
+
+    total = kmalloc(sizeof(*total), GFP_KERNEL);
+    if (!total)
+        return -ENOMEM;
+    sumar_stats(total);
+
+    spin_lock_irq(&fifo_lock);
+    for (prio = 0; prio < NUM_CARRILES; prio++)
+        ocupacion[prio] = kfifo_len(&carriles[prio].fifo) / sizeof(struct elemento);
+    spin_unlock_irq(&fifo_lock);
+
+    for (prio = NUM_CARRILES - 1; prio >= 0; prio--) {
+        snprintf(nombre, sizeof(nombre), "carril %d", prio);
+        seq_printf(m, "%s: ocupacion=%u\n", nombre, ocupacion[prio]);
+        mostrar_histograma(m, "latencia", total->lat_carril[prio]);
+    }
+
+    kfree(total);
     return 0;
 }
+DEFINE_SHOW_ATTRIBUTE(carriles);
 
-// Operación release para liberar recursos
-static int prodcons_release(struct inode *inode, struct file *file) {
-    spin_lock(&spin_count);
-    contador_referencias--;
-    spin_unlock(&spin_count);
+// Contadores y tiempos de espera/cerrojo: /sys/kernel/debug/prodcons/estadisticas
+static int estadisticas_show(struct seq_file *m, void *v) {
+    struct prodcons_stats *total;
 
-    module_put(THIS_MODULE);  // Decrementa contador de referencia
+    total = kmalloc(sizeof(*total), GFP_KERNEL);
+    if (!total)
+        return -ENOMEM;
+    sumar_stats(total);
+
+    seq_printf(m, "instrumentacion=%d\n", instrumentacion_activa());
+    seq_printf(m, "encolados=%llu desencolados=%llu\n", total->encolados, total->desencolados);
+    seq_printf(m, "descartados=%llu sobrescritos=%llu\n", total->descartados, total->sobrescritos);
+    seq_printf(m, "bloqueos_huecos=%llu bloqueos_elementos=%llu\n",
+               total->bloqueos_huecos, total->bloqueos_elementos);
+    mostrar_histograma(m, "espera en huecos", total->espera_huecos);
+    mostrar_histograma(m, "espera en elementos", total->espera_elementos);
+    mostrar_histograma(m, "retencion de fifo_lock", total->cerrojo);
+
+    kfree(total);
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(estadisticas);
+
+static int activar_get(void *data, u64 *val) {
+    *val = instrumentacion_activa();
+    return 0;
+}
+
+static int activar_set(void *data, u64 val) {
+    if (val)
+        static_branch_enable(&instrumentacion);
+    else
+        static_branch_disable(&instrumentacion);
+    return 0;
+}
+DEFINE_DEBUGFS_ATTRIBUTE(activar_fops, activar_get, activar_set, "%llu\n");
+
+// Cualquier escritura en .../reiniciar pone a cero contadores e histogramas
+static int reiniciar_set(void *data, u64 val) {
+    int cpu;
+
+    for_each_possible_cpu(cpu)
+        memset(per_cpu_ptr(&stats, cpu), 0, sizeof(struct prodcons_stats));
+    return 0;
+}
+DEFINE_DEBUGFS_ATTRIBUTE(reiniciar_fops, NULL, reiniciar_set, "%llu\n");
+
+// Número de elementos presentes en el anillo compartido
+static inline unsigned int shm_ocupacion(void) {
+    return READ_ONCE(shm_ctl->cabeza) - READ_ONCE(shm_ctl->cola);
+}
+
+/*
+ * Espera/despertar sobre el anillo compartido. Los índices los mueve el
+ * espacio de usuario sin llamadas al sistema; solo se entra aquí cuando el
+ * anillo está vacío (consumidor) o lleno (productor), tras marcar la bandera
+ * esperando_* correspondiente y volver a comprobar los índices.
+ */
+static long prodcons_ioctl(struct file *file, unsigned int cmd, unsigned long arg) {
+    switch (cmd) {
+    case PRODCONS_IOC_ESPERAR_ELEMENTOS:
+        if (wait_event_interruptible(shm_espera_elementos,
+                                     shm_ocupacion() != 0 || !aceptando()))
+            return -EINTR;
+        return shm_ocupacion() != 0 ? 0 : -ESHUTDOWN;
+    case PRODCONS_IOC_ESPERAR_HUECOS:
+        if (wait_event_interruptible(shm_espera_huecos,
+                                     shm_ocupacion() < shm_ctl->capacidad || !aceptando()))
+            return -EINTR;
+        return aceptando() ? 0 : -ESHUTDOWN;
+    case PRODCONS_IOC_DESPERTAR:
+        wake_up_interruptible(&shm_espera_elementos);
+        wake_up_interruptible(&shm_espera_huecos);
+        return 0;
+    default:
+        return -ENOTTY;
+    }
+}
+
+// Proyecta la página de control y el anillo compartido
+static int prodcons_mmap(struct file *file, struct vm_area_struct *vma) {
+    return remap_vmalloc_range(vma, shm_area, vma->vm_pgoff);
+}
+
+/*
+ * Operación open: la referencia al módulo la toma el núcleo gracias a
+ * .owner, así que basta con rechazar aperturas con el dispositivo cerrado.
+ */
+static int prodcons_open(struct inode *inode, struct file *file) {
+    if (READ_ONCE(estado) == PRODCONS_CERRADO)
+        return -ESHUTDOWN;
     return 0;
 }
 
@@ -138,7 +686,8 @@ static const struct file_operations prodcons_fops = {
     .write = prodcons_write,
     .read = prodcons_read,
     .open = prodcons_open,
-    .release = prodcons_release,
+    .unlocked_ioctl = prodcons_ioctl,
+    .mmap = prodcons_mmap,
 };
 
 /* Dispositivo misc */
@@ -149,46 +698,79 @@ static struct miscdevice prodcons_misc = {
     .mode = 0666,
 };
 
+// Libera los buffers de los n primeros carriles
+static void liberar_carriles(int n) {
+    while (n--)
+        kfifo_free(&carriles[n].fifo);
+}
+
 // Inicialización del módulo
 static int __init prodcons_init(void) {
 
-    int err;
+    int err, i;
+
+    if (shm_paginas <= 0 || !is_power_of_2(shm_paginas)) {
+        printk(KERN_ERR "shm_paginas debe ser potencia de 2\n");
+        return -EINVAL;
+    }
 
-    sema_init(&huecos,BUFFER_SIZE);
     sema_init(&elementos, 0);
-    sema_init(&mtx,1);
 
-    // Inicializar el buffer circular
-    if (kfifo_alloc(&fifo_buffer, BUFFER_SIZE * sizeof(int), GFP_KERNEL)) {
-        printk(KERN_ERR "Error al inicializar el buffer circular\n");
+    // Inicializar un buffer circular por carril
+    for (i = 0; i < NUM_CARRILES; i++) {
+        sema_init(&carriles[i].huecos, BUFFER_SIZE);
+        if (kfifo_alloc(&carriles[i].fifo, BUFFER_SIZE * sizeof(struct elemento), GFP_KERNEL)) {
+            printk(KERN_ERR "Error al inicializar el buffer circular\n");
+            liberar_carriles(i);
+            return -ENOMEM;
+        }
+    }
+
+    // Anillo compartido: página de control seguida de las páginas de datos
+    shm_area = vmalloc_user((1 + shm_paginas) * PAGE_SIZE);
+    if (!shm_area) {
+        liberar_carriles(NUM_CARRILES);
         return -ENOMEM;
     }
+    shm_ctl = shm_area;
+    shm_ctl->capacidad = shm_paginas * PAGE_SIZE / sizeof(int);
+    shm_ctl->offset_datos = PAGE_SIZE;
 
     err = misc_register(&prodcons_misc);
     if (err)
     {
-        kfifo_free(&fifo_buffer);
+        vfree(shm_area);
+        liberar_carriles(NUM_CARRILES);
         return err;
     }
 
+    debugfs_dir = debugfs_create_dir(DEVICE_NAME, NULL);
+    debugfs_create_file("carriles", 0444, debugfs_dir, NULL, &carriles_fops);
+    debugfs_create_file("estadisticas", 0444, debugfs_dir, NULL, &estadisticas_fops);
+    debugfs_create_file_unsafe("activar", 0644, debugfs_dir, NULL, &activar_fops);
+    debugfs_create_file_unsafe("reiniciar", 0200, debugfs_dir, NULL, &reiniciar_fops);
+
+    modulo_listo = true;
+
     printk(KERN_INFO "ProdCons: módulo cargado con éxito\n");
     return 0;
 }
 
-// Finalización del módulo
+/*
+ * Finalización del módulo. Mientras haya descriptores abiertos o módulos
+ * que usen la API interna el núcleo no deja llegar aquí; para descargar
+ * bajo carga primero se drena (parámetro `drenar`).
+ */
 static void __exit prodcons_exit(void) {
 
-    spin_lock(&spin_count);
-    if (contador_referencias > 0) {
-        spin_unlock(&spin_count);
-        pr_err("Device is in use. Cannot unload module.\n");
-        return;
-    }
-    spin_unlock(&spin_count);
-
+    cancel_delayed_work_sync(&fin_drenado);
 
+    debugfs_remove_recursive(debugfs_dir);
     misc_deregister(&prodcons_misc);
-    kfifo_free(&fifo_buffer);
+
+    volcar_restantes();
+    liberar_carriles(NUM_CARRILES);
+    vfree(shm_area);
 
     printk(KERN_INFO "ProdCons: módulo descargado con éxito\n");
 }
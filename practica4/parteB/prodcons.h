@@ -0,0 +1,68 @@
+/*
+ * prodcons.h
+ *
+ * Interfaz compartida entre el módulo prodcons y los programas de usuario
+ * que usan el anillo compartido (mmap) de /dev/prodcons.
+ *
+ * Disposición de la región mapeada:
+ *   - página 0: struct prodcons_shm_ctl (índices y banderas de espera)
+ *   - páginas 1..N: anillo de enteros con ctl->capacidad ranuras
+ *
+ * Incluye además la API interna del módulo para otros módulos del kernel.
+ *
+ * El anillo es de un productor y un consumidor (SPSC): el productor solo
+ * escribe `cabeza` y el consumidor solo escribe `cola`. El dispositivo solo
+ * interviene para dormir/despertar en las transiciones vacío/lleno.
+ */
+#ifndef PRODCONS_H
+#define PRODCONS_H
+
+#include <linux/types.h>
+#include <linux/ioctl.h>
+
+#define PRODCONS_CACHELINE 64
+
+struct prodcons_shm_ctl {
+    /* Lado productor */
+    __u32 cabeza;              // Siguiente ranura a escribir
+    __u32 esperando_huecos;    // El productor duerme esperando hueco
+    __u8 relleno0[PRODCONS_CACHELINE - 2 * sizeof(__u32)];
+
+    /* Lado consumidor */
+    __u32 cola;                // Siguiente ranura a leer
+    __u32 esperando_elementos; // El consumidor duerme esperando elemento
+    __u8 relleno1[PRODCONS_CACHELINE - 2 * sizeof(__u32)];
+
+    /* Solo lectura para usuario */
+    __u32 capacidad;           // Nº de ranuras (potencia de 2)
+    __u32 offset_datos;        // Desplazamiento en bytes del anillo
+};
+
+#define PRODCONS_IOC_MAGIC 'p'
+
+/* Duerme hasta que haya elementos en el anillo compartido */
+#define PRODCONS_IOC_ESPERAR_ELEMENTOS _IO(PRODCONS_IOC_MAGIC, 1)
+/* Duerme hasta que haya huecos en el anillo compartido */
+#define PRODCONS_IOC_ESPERAR_HUECOS    _IO(PRODCONS_IOC_MAGIC, 2)
+/* Despierta a los procesos dormidos en el anillo compartido */
+#define PRODCONS_IOC_DESPERTAR         _IO(PRODCONS_IOC_MAGIC, 3)
+
+#ifdef __KERNEL__
+/*
+ * API interna exportada a otros módulos. Los elementos insertados aquí se
+ * leen también desde /dev/prodcons. Todas devuelven -ESHUTDOWN cuando el
+ * dispositivo se está drenando (la extracción solo cuando ya está vacío).
+ */
+enum prodcons_politica {
+    PRODCONS_DESCARTAR,    // Buffer lleno: se pierde el elemento nuevo
+    PRODCONS_SOBRESCRIBIR  // Buffer lleno: se pierde el elemento más antiguo
+};
+
+#define PRODCONS_NUM_CARRILES 4 // prio válida: 0 (menor) .. PRODCONS_NUM_CARRILES - 1
+
+int prodcons_encolar(int num, int prio);
+int prodcons_encolar_atomico(int num, int prio, enum prodcons_politica politica);
+int prodcons_desencolar(int *num);
+#endif
+
+#endif /* PRODCONS_H */
@@ -0,0 +1,147 @@
+/*
+ * prodcons_hrtimer.c
+ *
+ * Módulo de prueba de la API interna de prodcons: un hrtimer inserta
+ * números de secuencia con prodcons_encolar_atomico() a alta frecuencia y
+ * un kthread los extrae con prodcons_desencolar(). Al descargar el módulo
+ * se informa de elementos perdidos y de la latencia inserción -> extracción.
+ *
+ * sudo insmod prodcons.ko
+ * sudo insmod prodcons_hrtimer.ko periodo_us=10 politica=0
+ * sleep 5; sudo rmmod prodcons_hrtimer; dmesg | tail
+ */
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/hrtimer.h>
+#include <linux/ktime.h>
+#include <linux/kthread.h>
+#include <linux/delay.h>
+#include <linux/sched/signal.h>
+#include "prodcons.h"
+
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("Juan y Lucas");
+MODULE_DESCRIPTION("Prueba de carga de la API interna de prodcons desde un hrtimer");
+
+static int periodo_us = 10;
+module_param(periodo_us, int, 0444);
+MODULE_PARM_DESC(periodo_us, "Periodo del hrtimer productor (us)");
+
+static int politica = PRODCONS_DESCARTAR;
+module_param(politica, int, 0444);
+MODULE_PARM_DESC(politica, "0 = descartar nuevo, 1 = sobrescribir antiguo");
+
+static int prio = 3;
+module_param(prio, int, 0444);
+MODULE_PARM_DESC(prio, "Carril en el que se insertan los elementos (0-3)");
+
+#define VENTANA 4096 // Marcas de tiempo recordadas (potencia de 2)
+#define FIN_PRUEBA -1
+
+static struct hrtimer timer;
+static struct task_struct *consumidor = NULL;
+static u64 t_envio[VENTANA];
+static int secuencia = 0;
+static bool parar = false;
+
+/* Estadísticas */
+static u64 enviados = 0, rechazados = 0;
+static u64 recibidos = 0, huecos_secuencia = 0;
+static u64 lat_total_ns = 0, lat_max_ns = 0;
+
+static enum hrtimer_restart productor(struct hrtimer *t)
+{
+    int seq = secuencia;
+
+    t_envio[seq & (VENTANA - 1)] = ktime_get_ns();
+    if (prodcons_encolar_atomico(seq, prio, politica))
+        rechazados++;
+    else
+        enviados++;
+    secuencia++;
+
+    if (READ_ONCE(parar))
+        return HRTIMER_NORESTART;
+
+    hrtimer_forward_now(t, us_to_ktime(periodo_us));
+    return HRTIMER_RESTART;
+}
+
+static int consumidor_fun(void *arg)
+{
+    int num, esperado = 0, ret;
+    u64 lat;
+
+    /* Para poder despertarlo si no se puede encolar FIN_PRUEBA */
+    allow_signal(SIGKILL);
+
+    while (!kthread_should_stop()) {
+        if ((ret = prodcons_desencolar(&num)) == -ESHUTDOWN)
+            break;
+        if (ret)
+            continue;
+        if (num == FIN_PRUEBA)
+            break;
+
+        lat = ktime_get_ns() - t_envio[num & (VENTANA - 1)];
+        lat_total_ns += lat;
+        if (lat > lat_max_ns)
+            lat_max_ns = lat;
+
+        if (num > esperado)
+            huecos_secuencia += num - esperado;
+        esperado = num + 1;
+        recibidos++;
+    }
+
+    /* Esperar a kthread_stop() */
+    while (!kthread_should_stop())
+        msleep(10);
+
+    return 0;
+}
+
+static int __init prodcons_hrtimer_init(void)
+{
+    if (periodo_us <= 0 || prio < 0 || prio >= PRODCONS_NUM_CARRILES)
+        return -EINVAL;
+
+    consumidor = kthread_run(consumidor_fun, NULL, "prodcons_cons");
+    if (IS_ERR(consumidor))
+        return PTR_ERR(consumidor);
+
+    hrtimer_init(&timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    timer.function = productor;
+    hrtimer_start(&timer, us_to_ktime(periodo_us), HRTIMER_MODE_REL);
+
+    pr_info("prodcons_hrtimer: insertando cada %d us en el carril %d\n", periodo_us, prio);
+    return 0;
+}
+
+static void __exit prodcons_hrtimer_exit(void)
+{
+    int ret;
+
+    WRITE_ONCE(parar, true);
+    hrtimer_cancel(&timer);
+
+    /*
+     * Desbloquear al consumidor con un marcador de fin. Si no se puede
+     * encolar (p. ej. prodcons drenando o cerrado), se le despierta con una
+     * señal: su down_interruptible() devuelve -EINTR.
+     */
+    while ((ret = prodcons_encolar_atomico(FIN_PRUEBA, prio, PRODCONS_DESCARTAR)) == -ENOSPC)
+        msleep(1);
+    if (ret)
+        send_sig(SIGKILL, consumidor, 1);
+    kthread_stop(consumidor);
+
+    pr_info("prodcons_hrtimer: enviados=%llu rechazados=%llu recibidos=%llu perdidos=%llu\n",
+            enviados, rechazados, recibidos, huecos_secuencia);
+    if (recibidos)
+        pr_info("prodcons_hrtimer: latencia media=%llu ns max=%llu ns\n",
+                div64_u64(lat_total_ns, recibidos), lat_max_ns);
+}
+
+module_init(prodcons_hrtimer_init);
+module_exit(prodcons_hrtimer_exit);
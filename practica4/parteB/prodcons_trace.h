@@ -0,0 +1,68 @@
+/*
+ * Tracepoints del módulo prodcons:
+ *   echo 1 > /sys/kernel/tracing/events/prodcons/enable
+ */
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM prodcons
+
+#if !defined(_PRODCONS_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _PRODCONS_TRACE_H
+
+#include <linux/tracepoint.h>
+
+TRACE_EVENT(prodcons_encolar,
+    TP_PROTO(int num, int prio, unsigned int ocupacion),
+    TP_ARGS(num, prio, ocupacion),
+    TP_STRUCT__entry(
+        __field(int, num)
+        __field(int, prio)
+        __field(unsigned int, ocupacion)
+    ),
+    TP_fast_assign(
+        __entry->num = num;
+        __entry->prio = prio;
+        __entry->ocupacion = ocupacion;
+    ),
+    TP_printk("num=%d carril=%d ocupacion=%u",
+              __entry->num, __entry->prio, __entry->ocupacion)
+);
+
+TRACE_EVENT(prodcons_desencolar,
+    TP_PROTO(int num, int prio, u64 latencia_ns),
+    TP_ARGS(num, prio, latencia_ns),
+    TP_STRUCT__entry(
+        __field(int, num)
+        __field(int, prio)
+        __field(u64, latencia_ns)
+    ),
+    TP_fast_assign(
+        __entry->num = num;
+        __entry->prio = prio;
+        __entry->latencia_ns = latencia_ns;
+    ),
+    TP_printk("num=%d carril=%d latencia=%llu ns",
+              __entry->num, __entry->prio, __entry->latencia_ns)
+);
+
+TRACE_EVENT(prodcons_espera,
+    TP_PROTO(int semaforo, u64 espera_ns),
+    TP_ARGS(semaforo, espera_ns),
+    TP_STRUCT__entry(
+        __field(int, semaforo)
+        __field(u64, espera_ns)
+    ),
+    TP_fast_assign(
+        __entry->semaforo = semaforo;
+        __entry->espera_ns = espera_ns;
+    ),
+    TP_printk("semaforo=%s espera=%llu ns",
+              __entry->semaforo ? "elementos" : "huecos", __entry->espera_ns)
+);
+
+#endif /* _PRODCONS_TRACE_H */
+
+/* Este fichero no está en include/trace/events */
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#define TRACE_INCLUDE_FILE prodcons_trace
+#include <trace/define_trace.h>
@@ -0,0 +1,61 @@
+#!/bin/bash
+
+# Descarga de prodcons con productores y consumidores activos.
+# Comprueba que todo lo producido se consume o queda en el volcado y que
+# ningún proceso se queda colgado tras el plazo de drenado.
+#
+# Uso (como root, desde este directorio): ./prueba_descarga.sh [n_procesos] [plazo_ms]
+
+N=${1:-8}
+PLAZO=${2:-2000}
+DIR=$(mktemp -d)
+VOLCADO=$DIR/volcado.txt
+
+rmmod prodcons 2>/dev/null
+insmod prodcons.ko volcado=$VOLCADO || exit 1
+
+productor() {
+    local k=0
+    while echo "$(( $1 % 4 )):$(( $1 * 1000000 + k ))" > /dev/prodcons 2>/dev/null; do
+        echo $(( $1 * 1000000 + k ))
+        k=$(( k + 1 ))
+    done > $DIR/prod_$1.txt
+}
+
+consumidor() {
+    while cat /dev/prodcons 2>/dev/null; do :; done > $DIR/cons_$1.txt
+}
+
+for i in $(seq 1 $N); do
+    productor $i &
+    consumidor $i &
+done
+
+sleep 3
+echo $PLAZO > /sys/module/prodcons/parameters/drenar
+
+# Todos los procesos deben terminar poco después del plazo
+sleep $(( PLAZO / 1000 + 2 ))
+if [ -n "$(jobs -r)" ]; then
+    echo "FALLO: procesos colgados tras el drenado"
+    jobs -l
+    kill $(jobs -p)
+    exit 1
+fi
+
+if ! timeout 10 rmmod prodcons; then
+    echo "FALLO: no se pudo descargar el módulo"
+    exit 1
+fi
+
+cat $DIR/prod_*.txt | sort -n > $DIR/producidos
+( cat $DIR/cons_*.txt; [ -f $VOLCADO ] && cut -d: -f2 $VOLCADO ) | sort -n > $DIR/recogidos
+
+if ! cmp -s $DIR/producidos $DIR/recogidos; then
+    echo "FALLO: elementos perdidos o duplicados"
+    diff $DIR/producidos $DIR/recogidos | head
+    exit 1
+fi
+
+echo "OK: $(wc -l < $DIR/producidos) elementos, $( [ -f $VOLCADO ] && wc -l < $VOLCADO || echo 0) volcados"
+rm -rf $DIR
@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# Llena el carril de menor prioridad y comprueba que un elemento de
+# control (prioridad 3) adelanta a los elementos de carga
+
+for i in {1..4}; do
+    echo "0:$i" > /dev/prodcons
+done
+echo "3:99" > /dev/prodcons
+
+primero=$(cat /dev/prodcons)
+if [ "$primero" != "99" ]; then
+    echo "FALLO: se esperaba 99 y se extrajo $primero"
+    exit 1
+fi
+
+for i in {1..4}; do
+    cat /dev/prodcons > /dev/null
+done
+
+echo "OK: el carril 3 adelanta al carril 0"
+cat /sys/kernel/debug/prodcons/carriles
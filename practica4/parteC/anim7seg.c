@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include "display7s.h"
+
+/*
+ * Compara el jitter de una animación temporizada por el kernel (ioctl
+ * DISPLAY7S_IOC_ANIMAR, un hrtimer entrega los cuadros) con la misma
+ * animación temporizada desde usuario (clock_nanosleep absoluto + write()
+ * por cuadro, como script.c pero sin acumular deriva).
+ * El jitter es el retraso de cada entrega respecto a su plazo ideal.
+ *
+ * Uso: ./anim7seg <kernel|usuario> [num_cuadros] [periodo_us]
+ */
+#define NS_POR_S 1000000000LL
+
+/* Segmentos de 0-f, iguales que en el driver */
+static const uint8_t hex[16] = {
+    0xfc, 0x60, 0xda, 0xf2, 0x66, 0xb6, 0xbe, 0xe0,
+    0xfe, 0xf6, 0xee, 0x3e, 0x9c, 0x7a, 0x9e, 0x8e
+};
+
+static int num_cuadros = 1000;
+static long periodo_us = 1000;
+
+static int64_t ahora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NS_POR_S + ts.tv_nsec;
+}
+
+static int animar_kernel(int fd) {
+    struct display7s_cuadro *cuadros = calloc(num_cuadros, sizeof(*cuadros));
+    struct display7s_animacion a;
+    char linea[256];
+    FILE *f;
+
+    if (!cuadros)
+        return -1;
+    for (int i = 0; i < num_cuadros; i++) {
+        memset(cuadros[i].segmentos, hex[i % 16], DISPLAY7S_MAX_DIGITOS);
+        cuadros[i].duracion_us = periodo_us;
+    }
+
+    a.cuadros = (uintptr_t)cuadros;
+    a.num_cuadros = num_cuadros;
+    a.repeticiones = 1;
+    if (ioctl(fd, DISPLAY7S_IOC_ANIMAR, &a) == -1) {
+        perror("ioctl");
+        return -1;
+    }
+    usleep(num_cuadros * periodo_us + 100000);
+
+    f = fopen("/sys/class/misc/display7s/estadisticas", "r");
+    while (f && fgets(linea, sizeof(linea), f))
+        if (strncmp(linea, "animacion=", 10) == 0)
+            printf("kernel: %s", linea);
+    if (f)
+        fclose(f);
+    free(cuadros);
+    return 0;
+}
+
+static int animar_usuario(int fd) {
+    const char characters[] = "0123456789abcdef";
+    struct timespec plazo;
+    int64_t inicio = ahora_ns() + periodo_us * 1000;
+    int64_t objetivo, retraso, total = 0, max = 0;
+    char buffer[3];
+
+    for (int i = 0; i < num_cuadros; i++) {
+        objetivo = inicio + (int64_t)i * periodo_us * 1000;
+        plazo.tv_sec = objetivo / NS_POR_S;
+        plazo.tv_nsec = objetivo % NS_POR_S;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &plazo, NULL);
+
+        snprintf(buffer, sizeof(buffer), "%c\n", characters[i % 16]);
+        if (write(fd, buffer, 2) == -1) {
+            perror("Error al escribir en el dispositivo");
+            return -1;
+        }
+        /* La entrega se completa al volver de write() */
+        retraso = ahora_ns() - objetivo;
+        total += retraso;
+        if (retraso > max)
+            max = retraso;
+    }
+
+    printf("usuario: cuadros=%d jitter_medio_ns=%lld jitter_max_ns=%lld\n",
+           num_cuadros, (long long)(total / num_cuadros), (long long)max);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int fd, ret;
+
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <kernel|usuario> [num_cuadros] [periodo_us]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (argc > 2)
+        num_cuadros = atoi(argv[2]);
+    if (argc > 3)
+        periodo_us = atol(argv[3]);
+    if (num_cuadros < 1 || num_cuadros > DISPLAY7S_MAX_CUADROS || periodo_us < 1) {
+        fprintf(stderr, "num_cuadros entre 1 y %d, periodo_us > 0\n", DISPLAY7S_MAX_CUADROS);
+        return EXIT_FAILURE;
+    }
+
+    fd = open("/dev/display7s", O_WRONLY);
+    if (fd == -1) {
+        perror("Error al abrir el dispositivo");
+        return EXIT_FAILURE;
+    }
+
+    if (strcmp(argv[1], "kernel") == 0)
+        ret = animar_kernel(fd);
+    else if (strcmp(argv[1], "usuario") == 0)
+        ret = animar_usuario(fd);
+    else {
+        fprintf(stderr, "Modo desconocido: %s\n", argv[1]);
+        ret = -1;
+    }
+
+    close(fd);
+    return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
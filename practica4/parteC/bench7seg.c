@@ -0,0 +1,47 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Mide cuántas actualizaciones por segundo admite /dev/display7s
+ * escribiendo dígitos tan rápido como sea posible.
+ *
+ * Uso: ./bench7seg [num_escrituras]
+ */
+int main(int argc, char *argv[]) {
+    const char characters[] = "0123456789abcdef";
+    const size_t num_chars = sizeof(characters) - 1;
+    const char *device_path = "/dev/display7s";
+    long num_escrituras = argc > 1 ? atol(argv[1]) : 10000;
+    struct timespec t0, t1;
+    char buffer[3];
+    double segundos;
+
+    int fd = open(device_path, O_WRONLY);
+    if (fd == -1) {
+        perror("Error al abrir el dispositivo");
+        return EXIT_FAILURE;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (long i = 0; i < num_escrituras; i++) {
+        snprintf(buffer, sizeof(buffer), "%c\n", characters[i % num_chars]);
+        if (write(fd, buffer, 2) == -1) {
+            perror("Error al escribir en el dispositivo");
+            close(fd);
+            return EXIT_FAILURE;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    segundos = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf("%ld escrituras en %.3f s: %.0f actualizaciones/s (%.1f us por escritura)\n",
+           num_escrituras, segundos, num_escrituras / segundos,
+           segundos * 1e6 / num_escrituras);
+
+    close(fd);
+    return EXIT_SUCCESS;
+}
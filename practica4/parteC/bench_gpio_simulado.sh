@@ -0,0 +1,17 @@
+#!/bin/bash
+
+# Carga drv7seg-smp sobre un chip GPIO simulado y mide actualizaciones/s.
+# Uso (como root, desde este directorio): ./bench_gpio_simulado.sh [parámetros del módulo]
+
+source ../../practica3/TestBee/gpio_simulado.sh
+
+base=$(gpio_simulado_crear 8) || exit 1
+make bench7seg || exit 1
+
+rmmod drv7seg-smp 2>/dev/null
+insmod drv7seg-smp.ko display_gpio=$(gpio_simulado_lineas $base 3) "$@" || exit 1
+
+./bench7seg 10000
+
+rmmod drv7seg-smp
+gpio_simulado_destruir
@@ -0,0 +1,45 @@
+#!/bin/bash
+
+# Coste de CPU del PWM de brillo sobre un chip GPIO simulado a varias
+# frecuencias. Para cada una carga el módulo con brillo=50, deja correr el
+# PWM y muestra el tiempo pasado en el hrtimer (según el propio driver) y
+# el tiempo en irq+softirq medido en /proc/stat, ambos en % de una CPU.
+# Uso (como root, desde este directorio): ./bench_pwm.sh [segundos] [frecuencias...]
+
+source ../../practica3/TestBee/gpio_simulado.sh
+
+SEGUNDOS=${1:-5}
+shift
+FRECUENCIAS=${@:-"100 500 1000 2000 5000 10000"}
+ESTADISTICAS=/sys/class/misc/display7s/estadisticas
+
+base=$(gpio_simulado_crear 4) || exit 1
+rmmod drv7seg-smp 2>/dev/null
+
+# Ticks de irq+softirq y totales de todas las CPU
+cpu_irq()   { awk '/^cpu /{print $7 + $8}' /proc/stat; }
+cpu_total() { awk '/^cpu /{s=0; for (i = 2; i <= NF; i++) s += $i; print s}' /proc/stat; }
+campo()     { grep -o "$1=[0-9]*" $ESTADISTICAS | cut -d= -f2; }
+
+printf "%8s %10s %14s %12s %10s\n" pwm_hz flancos/s coste_medio_ns cpu_hrtimer% irq+soft%
+for hz in $FRECUENCIAS; do
+    insmod drv7seg-smp.ko display_gpio=$(gpio_simulado_lineas $base 3) \
+        oe_gpio=$((base + 3)) pwm_hz=$hz brillo=50 || exit 1
+
+    f0=$(campo pwm_flancos); c0=$(campo pwm_coste_total_ns)
+    i0=$(cpu_irq); t0=$(cpu_total)
+    sleep $SEGUNDOS
+    f1=$(campo pwm_flancos); c1=$(campo pwm_coste_total_ns)
+    i1=$(cpu_irq); t1=$(cpu_total)
+
+    rmmod drv7seg-smp
+
+    flancos=$(( f1 - f0 ))
+    awk -v hz=$hz -v f=$flancos -v c=$(( c1 - c0 )) -v s=$SEGUNDOS \
+        -v di=$(( i1 - i0 )) -v dt=$(( t1 - t0 )) -v ncpu=$(nproc) 'BEGIN {
+        printf "%8d %10.0f %14.0f %12.4f %10.4f\n", hz, f / s, f ? c / f : 0,
+               100 * c / (s * 1e9), dt ? 100 * di / dt * ncpu : 0
+    }'
+done
+
+gpio_simulado_destruir
@@ -0,0 +1,802 @@
+/*
+ * display7s-core.c
+ *
+ * Núcleo del driver de display de 7 segmentos: /dev/display7s, escritura
+ * asíncrona, multiplexado, scroll, animaciones, brillo y sysfs. Los bytes
+ * salen por el transporte elegido y lo escrito se interpreta con el
+ * frontend elegido (ver display7s-core.h).
+ */
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/miscdevice.h>
+#include <linux/gpio.h>
+#include <linux/mutex.h>
+#include <linux/spinlock.h>
+#include <asm/uaccess.h>
+#include <asm/errno.h>
+#include <linux/workqueue.h>
+#include <linux/hrtimer.h>
+#include <linux/ktime.h>
+#include <linux/slab.h>
+#include <linux/list.h>
+#include <linux/sched.h>
+#include <linux/uaccess.h>
+#include "display7s-core.h"
+
+MODULE_DESCRIPTION("Display7s sincro");
+MODULE_AUTHOR("Lucas Calzada y Juan Girón");
+MODULE_LICENSE("GPL");
+
+/*
+ * Brillo: PWM por software sobre OE (activa a nivel bajo) del 74HC595 desde
+ * un hrtimer. Con oe_gpio < 0 OE va fija a masa y no hay control de brillo.
+ * El brillo (0-100 %) se cambia en /sys/class/misc/display7s/brillo; con 0
+ * o 100 el timer se para y OE queda fija.
+ */
+static int oe_gpio = -1;
+module_param(oe_gpio, int, 0444);
+MODULE_PARM_DESC(oe_gpio, "GPIO de OE del 74HC595 (-1 = sin PWM)");
+
+static unsigned int pwm_hz = 1000;
+module_param(pwm_hz, uint, 0444);
+MODULE_PARM_DESC(pwm_hz, "Frecuencia del PWM de brillo");
+
+static unsigned int brillo = 100;
+module_param(brillo, uint, 0444);
+MODULE_PARM_DESC(brillo, "Brillo inicial en % (0-100)");
+
+/* Transporte de salida y frontend de entrada (ver display7s-core.h) */
+static char *transporte = "gpio_array";
+module_param(transporte, charp, 0444);
+MODULE_PARM_DESC(transporte, "Transporte de salida: gpio, gpio_array o spi");
+
+static char *frontend = "texto";
+module_param(frontend, charp, 0444);
+MODULE_PARM_DESC(frontend, "Interpretación de lo escrito: secuencia, digito, multi o texto");
+
+static const struct display7s_transporte *transportes[] = {
+    &display7s_transporte_gpio,
+    &display7s_transporte_gpio_array,
+    &display7s_transporte_spi,
+};
+
+static const struct display7s_frontend *frontends[] = {
+    &display7s_frontend_secuencia,
+    &display7s_frontend_digito,
+    &display7s_frontend_multi,
+    &display7s_frontend_texto,
+};
+
+static const struct display7s_transporte *tr;
+static const struct display7s_frontend *fe;
+
+/*
+ * Displays de varios dígitos:
+ *  - encadenado (multiplexado=0): un 74HC595 por dígito en cascada; cada
+ *    actualización desplaza num_digitos bytes y hace un único latch.
+ *  - multiplexado (multiplexado=1): dos 74HC595 en cascada, el primero con
+ *    los segmentos y el segundo con la selección de dígito (one-hot, activa
+ *    a nivel alto). Un hrtimer refresca un dígito por ranura.
+ */
+static int num_digitos = 1;
+module_param(num_digitos, int, 0444);
+MODULE_PARM_DESC(num_digitos, "Número de dígitos del display (1-8)");
+
+static bool multiplexado = false;
+module_param(multiplexado, bool, 0444);
+MODULE_PARM_DESC(multiplexado, "Multiplexar los dígitos con un hrtimer");
+
+static int refresco_hz = 100;
+module_param(refresco_hz, int, 0444);
+MODULE_PARM_DESC(refresco_hz, "Cuadros completos por segundo en modo multiplexado");
+
+/*
+ * Scroll: un texto con más caracteres que dígitos se desplaza de derecha a
+ * izquierda desde un timer, un paso cada scroll_ms, dejando num_digitos
+ * blancos entre vueltas. Cualquier escritura posterior lo sustituye.
+ */
+static unsigned int scroll_ms = 300;
+module_param(scroll_ms, uint, 0644);
+MODULE_PARM_DESC(scroll_ms, "Milisegundos entre pasos del scroll");
+
+/*
+ * Escritura asíncrona: write() solo anota el último cuadro pedido y
+ * despierta a quien lo saca por el display, de modo que las escrituras
+ * intermedias se fusionan:
+ *  - sin multiplexar, el worker de una workqueue ordenada (nunca hay dos
+ *    actualizaciones del 74HC595 a la vez);
+ *  - multiplexado, el hrtimer de refresco al empezar cada cuadro.
+ * El cuadro pendiente y el visible forman un doble buffer: el hrtimer solo
+ * cambia de cuadro entre dos barridos completos, así que nunca se mezclan
+ * dígitos de dos escrituras distintas.
+ *
+ * Varios procesos pueden tener abierto el dispositivo a la vez. Gana la
+ * última escritura en tomar pendiente_lock; las anteriores aún no mostradas
+ * se cuentan como pisadas a su autor.
+ */
+struct escritor {
+    struct list_head lista;
+    pid_t pid;
+    char comm[TASK_COMM_LEN];
+    u64 escrituras;     // Peticiones aceptadas
+    u64 mostradas;      // Peticiones que llegaron al display
+    u64 pisadas;        // Peticiones sustituidas por otra antes de mostrarse
+};
+
+static struct workqueue_struct *display_wq;
+static struct work_struct display_work;
+static DEFINE_SPINLOCK(pendiente_lock);   // Protege el cuadro pendiente y estadísticas
+static unsigned char cuadro_pendiente[MAX_DIGITOS];
+static bool hay_pendiente = false;
+static struct escritor *autor_pendiente = NULL; // NULL: scroll o ya cerrado
+static LIST_HEAD(escritores);             // Descriptores abiertos
+static u64 escrituras = 0;                // Peticiones aceptadas por write() (no cuenta pasos de scroll)
+static u64 aplicadas = 0;                 // Actualizaciones sacadas al display
+static u64 fusionadas = 0;                // Peticiones pisadas por otra posterior
+static unsigned char cuadro_enviado[MAX_DIGITOS]; // Último cuadro entregado al transporte
+
+/* Refresco multiplexado */
+static struct hrtimer refresco_timer;
+static ktime_t periodo_ranura;
+static unsigned char cuadro_visible[MAX_DIGITOS]; // Solo lo toca el hrtimer
+static int digito_actual = 0;
+static u64 refrescos = 0;                 // Ranuras (dígitos) refrescadas
+static u64 coste_total_ns = 0, coste_max_ns = 0;
+static u64 retraso_total_ns = 0, retraso_max_ns = 0;
+
+/* Worker: saca por el display el último cuadro pedido hasta que no quede ninguno */
+static void display_work_fn(struct work_struct *work)
+{
+    unsigned char cuadro[MAX_DIGITOS];
+    int i;
+
+    for (;;) {
+        spin_lock_irq(&pendiente_lock);
+        if (!hay_pendiente) {
+            spin_unlock_irq(&pendiente_lock);
+            break;
+        }
+        /* El dígito 0 (izquierda) va al último registro de la cadena */
+        for (i = 0; i < num_digitos; i++)
+            cuadro[i] = cuadro_pendiente[i];
+        memcpy(cuadro_enviado, cuadro, num_digitos);
+        hay_pendiente = false;
+        aplicadas++;
+        if (autor_pendiente)
+            autor_pendiente->mostradas++;
+        spin_unlock_irq(&pendiente_lock);
+
+        tr->enviar(cuadro, num_digitos);
+    }
+}
+
+/* Para los transportes: nº de dígitos (fijo desde la carga del módulo) */
+int display7s_num_digitos(void)
+{
+    return num_digitos;
+}
+
+/* Para el transporte: espera a que el worker termine lo que tenga en curso */
+void display7s_esperar_worker(void)
+{
+    flush_workqueue(display_wq);
+}
+
+/* hrtimer: enciende el siguiente dígito del cuadro visible */
+static enum hrtimer_restart refresco_fn(struct hrtimer *timer)
+{
+    u64 t0 = ktime_get_ns();
+    u64 retraso = t0 - ktime_to_ns(hrtimer_get_expires(timer));
+    unsigned char bytes[2];
+    u64 coste;
+
+    if (digito_actual == 0) {
+        spin_lock(&pendiente_lock);
+        if (hay_pendiente) {
+            memcpy(cuadro_visible, cuadro_pendiente, num_digitos);
+            memcpy(cuadro_enviado, cuadro_pendiente, num_digitos);
+            hay_pendiente = false;
+            aplicadas++;
+            if (autor_pendiente)
+                autor_pendiente->mostradas++;
+        }
+        spin_unlock(&pendiente_lock);
+    }
+
+    /* Selección primero: acaba en el segundo registro de la cadena */
+    bytes[0] = 1 << digito_actual;
+    bytes[1] = cuadro_visible[digito_actual];
+    tr->enviar_atomico(bytes, 2);
+
+    digito_actual = (digito_actual + 1) % num_digitos;
+
+    coste = ktime_get_ns() - t0;
+    refrescos++;
+    coste_total_ns += coste;
+    retraso_total_ns += retraso;
+    if (coste > coste_max_ns)
+        coste_max_ns = coste;
+    if (retraso > retraso_max_ns)
+        retraso_max_ns = retraso;
+
+    hrtimer_forward_now(timer, periodo_ranura);
+    return HRTIMER_RESTART;
+}
+
+/* Estado del scroll */
+static struct timer_list scroll_timer;
+static DEFINE_SPINLOCK(scroll_lock);      // Protege el texto y la posición del scroll
+static unsigned char texto_scroll[MAX_DIGITOS + MAX_TEXTO]; // Blancos + texto
+static int scroll_len = 0;                // 0 = sin scroll
+static int scroll_pos = 0;
+static u64 pasos_scroll = 0;
+
+static void solicitar_7sdisplay(const unsigned char *cuadro, struct escritor *autor);
+
+/* Timer: saca la siguiente ventana del texto y se rearma */
+static void scroll_fn(struct timer_list *t)
+{
+    unsigned char cuadro[MAX_DIGITOS];
+    unsigned long flags;
+    int i;
+
+    spin_lock_irqsave(&scroll_lock, flags);
+    if (scroll_len == 0) {
+        spin_unlock_irqrestore(&scroll_lock, flags);
+        return;
+    }
+    for (i = 0; i < num_digitos; i++)
+        cuadro[i] = texto_scroll[(scroll_pos + i) % scroll_len];
+    scroll_pos = (scroll_pos + 1) % scroll_len;
+    pasos_scroll++;
+    mod_timer(&scroll_timer, jiffies + msecs_to_jiffies(max(scroll_ms, 1U)));
+    spin_unlock_irqrestore(&scroll_lock, flags);
+
+    solicitar_7sdisplay(cuadro, NULL);
+}
+
+/* Arranca el scroll de n glifos (n == 0 lo detiene) */
+static void programar_scroll(const unsigned char *segs, int n)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&scroll_lock, flags);
+    if (n > 0) {
+        memset(texto_scroll, 0, num_digitos);
+        memcpy(texto_scroll + num_digitos, segs, n);
+        scroll_len = num_digitos + n;
+        scroll_pos = 0;
+        mod_timer(&scroll_timer, jiffies);
+    } else {
+        scroll_len = 0;
+    }
+    spin_unlock_irqrestore(&scroll_lock, flags);
+
+    if (n == 0)
+        del_timer_sync(&scroll_timer);
+}
+
+/*
+ * Anota el cuadro pedido y despierta al worker sin esperar a la
+ * actualización. autor es NULL para los cuadros del scroll.
+ */
+static void solicitar_7sdisplay(const unsigned char *cuadro, struct escritor *autor)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&pendiente_lock, flags);
+    if (hay_pendiente) {
+        fusionadas++;
+        if (autor_pendiente)
+            autor_pendiente->pisadas++;
+    }
+    memcpy(cuadro_pendiente, cuadro, num_digitos);
+    hay_pendiente = true;
+    autor_pendiente = autor;
+    if (autor) {
+        escrituras++;
+        autor->escrituras++;
+    }
+    spin_unlock_irqrestore(&pendiente_lock, flags);
+
+    if (!multiplexado)
+        queue_work(display_wq, &display_work);
+}
+
+/* PWM de brillo */
+static struct gpio_desc *oe_desc = NULL;
+static DEFINE_MUTEX(pwm_mutex);           // Serializa los cambios de brillo
+static struct hrtimer pwm_timer;
+static u64 pwm_periodo_ns;
+static bool pwm_encendido = false;        // Fase actual; solo la toca el hrtimer
+static u64 pwm_flancos = 0;
+static u64 pwm_coste_total_ns = 0, pwm_coste_max_ns = 0;
+
+/* hrtimer: alterna OE entre la fase encendida y la apagada */
+static enum hrtimer_restart pwm_fn(struct hrtimer *timer)
+{
+    u64 t0 = ktime_get_ns();
+    u64 encendido_ns = div_u64(pwm_periodo_ns * READ_ONCE(brillo), 100);
+    u64 coste;
+
+    pwm_encendido = !pwm_encendido;
+    gpiod_set_value(oe_desc, !pwm_encendido);
+    hrtimer_forward_now(timer, ns_to_ktime(pwm_encendido ? encendido_ns
+                                                          : pwm_periodo_ns - encendido_ns));
+
+    coste = ktime_get_ns() - t0;
+    pwm_flancos++;
+    pwm_coste_total_ns += coste;
+    if (coste > pwm_coste_max_ns)
+        pwm_coste_max_ns = coste;
+
+    return HRTIMER_RESTART;
+}
+
+/* Aplica un brillo nuevo. Llamar con pwm_mutex */
+static void aplicar_brillo_locked(unsigned int b)
+{
+    WRITE_ONCE(brillo, b);
+
+    if (b == 0 || b == 100) {
+        hrtimer_cancel(&pwm_timer);
+        gpiod_set_value(oe_desc, b == 0);
+        pwm_encendido = b != 0;
+    } else if (!hrtimer_active(&pwm_timer)) {
+        hrtimer_start(&pwm_timer, 0, HRTIMER_MODE_REL);
+    }
+}
+
+/* Animaciones (ioctl DISPLAY7S_IOC_ANIMAR) */
+static DEFINE_MUTEX(anim_mutex);          // Serializa arranque y parada
+static struct hrtimer anim_timer;
+static struct display7s_cuadro *anim_cuadros = NULL; // Solo cambia con el timer parado
+static u32 anim_num = 0, anim_repeticiones = 0;
+static u32 anim_actual = 0, anim_vuelta = 0;
+static bool anim_activa = false;
+static u64 anim_mostrados = 0;            // Cuadros entregados en la animación actual
+static u64 anim_retraso_total_ns = 0, anim_retraso_max_ns = 0;
+static u64 anim_saltos = 0;               // Plazos perdidos por cuadros que llegaron tarde
+
+/*
+ * hrtimer: entrega el cuadro actual y programa el siguiente en plazo
+ * absoluto. Si el cuadro llegó tarde, el siguiente plazo se lleva al primer
+ * múltiplo de su duración que aún no ha pasado (en lugar de encadenar
+ * cuadros seguidos para recuperar) y los plazos saltados se cuentan.
+ */
+static enum hrtimer_restart anim_fn(struct hrtimer *timer)
+{
+    u64 retraso = ktime_get_ns() - ktime_to_ns(hrtimer_get_expires(timer));
+    struct display7s_cuadro *c = &anim_cuadros[anim_actual];
+
+    solicitar_7sdisplay(c->segmentos, NULL);
+
+    anim_mostrados++;
+    anim_retraso_total_ns += retraso;
+    if (retraso > anim_retraso_max_ns)
+        anim_retraso_max_ns = retraso;
+
+    anim_saltos += hrtimer_forward_now(timer, ns_to_ktime((u64)c->duracion_us * NSEC_PER_USEC)) - 1;
+
+    if (++anim_actual == anim_num) {
+        anim_actual = 0;
+        if (anim_repeticiones && ++anim_vuelta == anim_repeticiones) {
+            WRITE_ONCE(anim_activa, false);
+            return HRTIMER_NORESTART;
+        }
+    }
+    return HRTIMER_RESTART;
+}
+
+/* Para la animación en curso. Llamar con anim_mutex */
+static void parar_animacion_locked(void)
+{
+    hrtimer_cancel(&anim_timer);
+    WRITE_ONCE(anim_activa, false);
+    kfree(anim_cuadros);
+    anim_cuadros = NULL;
+}
+
+static void parar_animacion(void)
+{
+    mutex_lock(&anim_mutex);
+    if (anim_cuadros)
+        parar_animacion_locked();
+    mutex_unlock(&anim_mutex);
+}
+
+static long display7s_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
+{
+    struct display7s_animacion a;
+    struct display7s_cuadro *cuadros;
+    u32 i;
+
+    switch (cmd) {
+    case DISPLAY7S_IOC_ANIMAR:
+        if (copy_from_user(&a, (void __user *)arg, sizeof(a)))
+            return -EFAULT;
+        if (a.num_cuadros < 1 || a.num_cuadros > DISPLAY7S_MAX_CUADROS)
+            return -EINVAL;
+
+        cuadros = memdup_user(u64_to_user_ptr(a.cuadros), a.num_cuadros * sizeof(*cuadros));
+        if (IS_ERR(cuadros))
+            return PTR_ERR(cuadros);
+        for (i = 0; i < a.num_cuadros; i++) {
+            if (cuadros[i].duracion_us == 0) {
+                kfree(cuadros);
+                return -EINVAL;
+            }
+        }
+
+        programar_scroll(NULL, 0);
+
+        mutex_lock(&anim_mutex);
+        parar_animacion_locked();
+        anim_cuadros = cuadros;
+        anim_num = a.num_cuadros;
+        anim_repeticiones = a.repeticiones;
+        anim_actual = 0;
+        anim_vuelta = 0;
+        anim_mostrados = 0;
+        anim_retraso_total_ns = 0;
+        anim_retraso_max_ns = 0;
+        anim_saltos = 0;
+        anim_activa = true;
+        hrtimer_start(&anim_timer, ktime_get(), HRTIMER_MODE_ABS);
+        mutex_unlock(&anim_mutex);
+        return 0;
+    case DISPLAY7S_IOC_PARAR:
+        parar_animacion();
+        return 0;
+    default:
+        return -ENOTTY;
+    }
+}
+
+/*
+ * Implementación de operaciones. Se acepta un texto de hasta MAX_TEXTO
+ * caracteres, opcionalmente terminado en '\n', que el frontend traduce a
+ * glifos. Si caben en el display se alinean a la derecha; si no, se
+ * muestran con scroll o se rechazan, según el frontend.
+ */
+static ssize_t display7s_write(struct file *filp, const char *buff, size_t len, loff_t *off)
+{
+    unsigned char kbuf[MAX_TEXTO + 1];
+    unsigned char segs[MAX_TEXTO];
+    unsigned char cuadro[MAX_DIGITOS] = {0};
+    int n = len;
+
+    if (len < 1 || len > MAX_TEXTO + 1)
+        return -EINVAL;
+
+    if (copy_from_user(kbuf, buff, len))
+        return -EFAULT;
+
+    if (kbuf[n - 1] == '\n')
+        n--;
+    if (n > MAX_TEXTO)
+        return -EINVAL;
+
+    if ((n = fe->traducir(kbuf, n, segs)) < 0)
+        return n;
+    if (n > num_digitos && !fe->scroll)
+        return -EINVAL;
+
+    parar_animacion();
+
+    if (n > num_digitos) {
+        struct escritor *yo = filp->private_data;
+
+        programar_scroll(segs, n);
+        spin_lock_irq(&pendiente_lock);
+        escrituras++;
+        yo->escrituras++;
+        spin_unlock_irq(&pendiente_lock);
+        return len;
+    }
+
+    programar_scroll(NULL, 0);
+    memcpy(cuadro + num_digitos - n, segs, n);
+    solicitar_7sdisplay(cuadro, filp->private_data);
+
+    return len;
+}
+
+/* Cada apertura lleva sus propias estadísticas de escritor */
+static int display7s_open(struct inode *inode, struct file *file)
+{
+    struct escritor *yo = kzalloc(sizeof(*yo), GFP_KERNEL);
+
+    if (!yo)
+        return -ENOMEM;
+
+    yo->pid = task_tgid_vnr(current);
+    get_task_comm(yo->comm, current);
+
+    spin_lock_irq(&pendiente_lock);
+    list_add_tail(&yo->lista, &escritores);
+    spin_unlock_irq(&pendiente_lock);
+
+    file->private_data = yo;
+    return 0;
+}
+
+static int display7s_release(struct inode *inode, struct file *file)
+{
+    struct escritor *yo = file->private_data;
+
+    /* El cuadro pendiente se mostrará igualmente, pero ya sin autor */
+    spin_lock_irq(&pendiente_lock);
+    if (autor_pendiente == yo)
+        autor_pendiente = NULL;
+    list_del(&yo->lista);
+    spin_unlock_irq(&pendiente_lock);
+
+    kfree(yo);
+    return 0;
+}
+
+/* Operaciones de dispositivo */
+static const struct file_operations fops = {
+    .owner = THIS_MODULE,
+    .write = display7s_write,
+    .open = display7s_open,
+    .release = display7s_release,
+    .unlocked_ioctl = display7s_ioctl,
+    .compat_ioctl = compat_ptr_ioctl,
+};
+
+/* Estadísticas: cat /sys/class/misc/display7s/estadisticas */
+static ssize_t estadisticas_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    u64 e, a, f, r, c_tot, c_max, d_tot, d_max;
+    int len;
+
+    spin_lock_irq(&pendiente_lock);
+    e = escrituras;
+    a = aplicadas;
+    f = fusionadas;
+    spin_unlock_irq(&pendiente_lock);
+
+    len = sysfs_emit(buf, "escrituras=%llu aplicadas=%llu fusionadas=%llu\n", e, a, f);
+
+    len += sysfs_emit_at(buf, len, "transporte=%s frontend=%s\n", tr->nombre, fe->nombre);
+    if (tr->estadisticas)
+        len = tr->estadisticas(buf, len);
+
+    spin_lock_irq(&scroll_lock);
+    len += sysfs_emit_at(buf, len, "scroll=%s pasos_scroll=%llu\n",
+                         scroll_len ? "activo" : "parado", pasos_scroll);
+    spin_unlock_irq(&scroll_lock);
+
+    /* Las toca el hrtimer de animación sin cerrojo: lectura aproximada */
+    r = READ_ONCE(anim_mostrados);
+    d_tot = READ_ONCE(anim_retraso_total_ns);
+    d_max = READ_ONCE(anim_retraso_max_ns);
+    len += sysfs_emit_at(buf, len, "animacion=%s cuadros=%llu saltos=%llu",
+                         READ_ONCE(anim_activa) ? "activa" : "parada", r, READ_ONCE(anim_saltos));
+    if (r)
+        len += sysfs_emit_at(buf, len, " jitter_medio_ns=%llu jitter_max_ns=%llu",
+                             div64_u64(d_tot, r), d_max);
+    len += sysfs_emit_at(buf, len, "\n");
+
+    if (oe_desc) {
+        /* Las toca el hrtimer del PWM sin cerrojo: lectura aproximada */
+        r = READ_ONCE(pwm_flancos);
+        c_tot = READ_ONCE(pwm_coste_total_ns);
+        c_max = READ_ONCE(pwm_coste_max_ns);
+        len += sysfs_emit_at(buf, len, "brillo=%u pwm_flancos=%llu", READ_ONCE(brillo), r);
+        if (r)
+            len += sysfs_emit_at(buf, len, " pwm_coste_total_ns=%llu pwm_coste_medio_ns=%llu pwm_coste_max_ns=%llu",
+                                 c_tot, div64_u64(c_tot, r), c_max);
+        len += sysfs_emit_at(buf, len, "\n");
+    }
+
+    if (multiplexado) {
+        /* Las toca el hrtimer sin cerrojo: lectura aproximada */
+        r = READ_ONCE(refrescos);
+        c_tot = READ_ONCE(coste_total_ns);
+        c_max = READ_ONCE(coste_max_ns);
+        d_tot = READ_ONCE(retraso_total_ns);
+        d_max = READ_ONCE(retraso_max_ns);
+        if (r)
+            len += sysfs_emit_at(buf, len,
+                                 "refrescos=%llu coste_medio_ns=%llu coste_max_ns=%llu "
+                                 "retraso_medio_ns=%llu retraso_max_ns=%llu\n",
+                                 r, div64_u64(c_tot, r), c_max, div64_u64(d_tot, r), d_max);
+    }
+
+    return len;
+}
+static DEVICE_ATTR_RO(estadisticas);
+
+/*
+ * Una línea por descriptor abierto. Si no caben todas en la página, las
+ * que sobran se resumen en una última línea "... y N mas".
+ */
+#define RESERVA_OMITIDOS 32
+
+static ssize_t escritores_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    struct escritor *e;
+    char linea[128];
+    int len = 0, n, omitidos = 0;
+
+    spin_lock_irq(&pendiente_lock);
+    list_for_each_entry(e, &escritores, lista) {
+        n = scnprintf(linea, sizeof(linea),
+                      "pid=%d comm=%s escrituras=%llu mostradas=%llu pisadas=%llu\n",
+                      e->pid, e->comm, e->escrituras, e->mostradas, e->pisadas);
+        if (omitidos || len + n > PAGE_SIZE - RESERVA_OMITIDOS) {
+            omitidos++;
+            continue;
+        }
+        memcpy(buf + len, linea, n);
+        len += n;
+    }
+    spin_unlock_irq(&pendiente_lock);
+
+    if (omitidos)
+        len += sysfs_emit_at(buf, len, "... y %d mas\n", omitidos);
+    return len;
+}
+static DEVICE_ATTR_RO(escritores);
+
+/* Brillo: cat/echo N > /sys/class/misc/display7s/brillo */
+static ssize_t brillo_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    return sysfs_emit(buf, "%u\n", READ_ONCE(brillo));
+}
+
+static ssize_t brillo_store(struct device *dev, struct device_attribute *attr,
+                            const char *buf, size_t count)
+{
+    unsigned int b;
+    int err;
+
+    if (!oe_desc)
+        return -ENODEV;
+    if ((err = kstrtouint(buf, 10, &b)))
+        return err;
+    if (b > 100)
+        return -EINVAL;
+
+    mutex_lock(&pwm_mutex);
+    aplicar_brillo_locked(b);
+    mutex_unlock(&pwm_mutex);
+
+    return count;
+}
+static DEVICE_ATTR_RW(brillo);
+
+/* Último cuadro entregado al transporte, en hexadecimal (para las pruebas) */
+static ssize_t cuadro_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    int i, len = 0;
+
+    spin_lock_irq(&pendiente_lock);
+    for (i = 0; i < num_digitos; i++)
+        len += sysfs_emit_at(buf, len, "%02x%c", cuadro_enviado[i],
+                             i == num_digitos - 1 ? '\n' : ' ');
+    spin_unlock_irq(&pendiente_lock);
+
+    return len;
+}
+static DEVICE_ATTR_RO(cuadro);
+
+static struct attribute *display7s_attrs[] = {
+    &dev_attr_estadisticas.attr,
+    &dev_attr_escritores.attr,
+    &dev_attr_brillo.attr,
+    &dev_attr_cuadro.attr,
+    NULL,
+};
+
+static const struct attribute_group display7s_grupo = {
+    .attrs = display7s_attrs,
+};
+
+/* El grupo del núcleo y, si lo tiene, el del transporte (se pone al cargar) */
+static const struct attribute_group *display7s_groups[3] = {
+    &display7s_grupo,
+};
+
+/* Dispositivo misc */
+static struct miscdevice display7s_misc = {
+    .minor = MISC_DYNAMIC_MINOR,
+    .name = "display7s",
+    .fops = &fops,
+    .mode = 0666,
+    .groups = display7s_groups,
+};
+
+
+static int __init display7s_misc_init(void)
+{
+    int i, err;
+
+    if (num_digitos < 1 || num_digitos > MAX_DIGITOS || refresco_hz <= 0 ||
+        brillo > 100 || pwm_hz == 0)
+        return -EINVAL;
+
+    tr = NULL;
+    for (i = 0; i < ARRAY_SIZE(transportes); i++)
+        if (strcmp(transporte, transportes[i]->nombre) == 0)
+            tr = transportes[i];
+    fe = NULL;
+    for (i = 0; i < ARRAY_SIZE(frontends); i++)
+        if (strcmp(frontend, frontends[i]->nombre) == 0)
+            fe = frontends[i];
+    if (!tr || !fe)
+        return -EINVAL;
+    display7s_groups[1] = tr->atributos;
+
+    display_wq = alloc_ordered_workqueue("display7s", WQ_HIGHPRI);
+    if (!display_wq)
+        return -ENOMEM;
+    INIT_WORK(&display_work, display_work_fn);
+    timer_setup(&scroll_timer, scroll_fn, 0);
+    hrtimer_init(&anim_timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+    anim_timer.function = anim_fn;
+
+    if ((err = tr->iniciar()))
+        goto err_wq;
+
+    if (oe_gpio >= 0) {
+        if ((err = gpio_request(oe_gpio, "display7s-oe")))
+            goto err_transporte;
+        oe_desc = gpio_to_desc(oe_gpio);
+        gpiod_direction_output(oe_desc, 1);
+        pwm_periodo_ns = div_u64(NSEC_PER_SEC, pwm_hz);
+        hrtimer_init(&pwm_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+        pwm_timer.function = pwm_fn;
+        mutex_lock(&pwm_mutex);
+        aplicar_brillo_locked(brillo);
+        mutex_unlock(&pwm_mutex);
+    }
+
+    if (multiplexado) {
+        periodo_ranura = ns_to_ktime(div_u64(NSEC_PER_SEC, refresco_hz * num_digitos));
+        hrtimer_init(&refresco_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+        refresco_timer.function = refresco_fn;
+        hrtimer_start(&refresco_timer, periodo_ranura, HRTIMER_MODE_REL);
+    }
+
+    if ((err = misc_register(&display7s_misc)))
+        goto err_timers;
+
+    return 0;
+
+err_timers:
+    if (multiplexado)
+        hrtimer_cancel(&refresco_timer);
+    if (oe_desc) {
+        hrtimer_cancel(&pwm_timer);
+        gpio_free(oe_gpio);
+        oe_desc = NULL;
+    }
+err_transporte:
+    tr->liberar();
+err_wq:
+    destroy_workqueue(display_wq);
+    return err;
+}
+
+static void __exit display7s_misc_exit(void)
+{
+    misc_deregister(&display7s_misc);
+    programar_scroll(NULL, 0);
+    parar_animacion();
+    if (oe_desc) {
+        hrtimer_cancel(&pwm_timer);
+        gpio_free(oe_gpio);
+    }
+    if (multiplexado)
+        hrtimer_cancel(&refresco_timer);
+    flush_workqueue(display_wq); // Espera a la última actualización
+    tr->liberar();
+    destroy_workqueue(display_wq);
+}
+
+module_init(display7s_misc_init);
+module_exit(display7s_misc_exit);
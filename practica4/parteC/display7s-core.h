@@ -0,0 +1,79 @@
+/*
+ * display7s-core.h
+ *
+ * Piezas internas del driver de display de 7 segmentos (drv7seg-smp.ko):
+ *   - display7s-core.c: dispositivo /dev/display7s, escritura asíncrona,
+ *     multiplexado, scroll, animaciones, brillo y sysfs;
+ *   - display7s-gpio.c: transportes "gpio" (una línea cada vez) y
+ *     "gpio_array" (pares de líneas con gpiod_set_array_value);
+ *   - display7s-spi.c: transporte "spi" (gpio_array de respaldo opcional);
+ *   - display7s-frontend.c: glifos y frontends "secuencia", "digito",
+ *     "multi" y "texto".
+ * El transporte y el frontend se eligen al cargar el módulo.
+ */
+#ifndef DISPLAY7S_CORE_H
+#define DISPLAY7S_CORE_H
+
+#include <linux/types.h>
+#include <linux/device.h>
+#include <linux/sysfs.h>
+#include "display7s.h"
+
+#define DS_A 0x80
+#define DS_B 0x40
+#define DS_C 0x20
+#define DS_D 0x10
+#define DS_E 0x08
+#define DS_F 0x04
+#define DS_G 0x02
+#define DS_DP 0x01
+#define SEGMENT_COUNT 8
+
+#define MAX_DIGITOS DISPLAY7S_MAX_DIGITOS
+#define MAX_TEXTO 128
+
+/*
+ * Transporte: cómo llegan los bytes a la cadena de 74HC595. En ambos casos
+ * el primer byte acaba en el último registro y hay un único latch.
+ * enviar() se llama desde el worker y puede dormir; enviar_atomico() se
+ * llama desde los hrtimer y no puede. estadisticas() es opcional y añade
+ * líneas al fichero de estadísticas a partir de len; atributos, también
+ * opcional, se añade a los de /sys/class/misc/display7s.
+ */
+struct display7s_transporte {
+    const char *nombre;
+    int (*iniciar)(void);
+    void (*liberar)(void);
+    void (*enviar)(const unsigned char *data, int n);
+    void (*enviar_atomico)(const unsigned char *data, int n);
+    int (*estadisticas)(char *buf, int len);
+    const struct attribute_group *atributos;
+};
+
+extern const struct display7s_transporte display7s_transporte_gpio;
+extern const struct display7s_transporte display7s_transporte_gpio_array;
+extern const struct display7s_transporte display7s_transporte_spi;
+
+/*
+ * Frontend: cómo se interpreta lo escrito en /dev/display7s. traducir()
+ * convierte len caracteres (len puede ser 0 si solo se escribió '\n') en
+ * glifos y devuelve cuántos hay, o -EINVAL.
+ * Si hay más glifos que dígitos, el núcleo los anima con scroll cuando el
+ * frontend lo admite y rechaza la escritura si no.
+ */
+struct display7s_frontend {
+    const char *nombre;
+    int (*traducir)(const unsigned char *texto, int len, unsigned char *segs);
+    bool scroll;
+};
+
+extern const struct display7s_frontend display7s_frontend_secuencia;
+extern const struct display7s_frontend display7s_frontend_digito;
+extern const struct display7s_frontend display7s_frontend_multi;
+extern const struct display7s_frontend display7s_frontend_texto;
+
+/* Del núcleo, para los transportes */
+int display7s_num_digitos(void);
+void display7s_esperar_worker(void);
+
+#endif /* DISPLAY7S_CORE_H */
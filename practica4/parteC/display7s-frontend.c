@@ -0,0 +1,168 @@
+/*
+ * display7s-frontend.c
+ *
+ * Frontends del display: cómo se traduce lo escrito en /dev/display7s a
+ * segmentos.
+ *   - "secuencia": cada escritura enciende el siguiente segmento, sea cual
+ *     sea su contenido (el antiguo Misc7seg de la práctica 3);
+ *   - "digito": un único carácter hexadecimal (el antiguo misc7seg de la
+ *     práctica 3, PARTEC);
+ *   - "multi": hasta num_digitos caracteres de la tabla de glifos;
+ *   - "texto": cualquier longitud hasta MAX_TEXTO, con scroll si no cabe.
+ */
+#include <linux/kernel.h>
+#include <linux/ctype.h>
+#include <linux/atomic.h>
+#include "display7s-core.h"
+
+/*
+ * Glifos por código ASCII. Lo que no cabe bien en 7 segmentos es una
+ * aproximación; un 0 significa carácter no representable (salvo ' ').
+ * Las minúsculas sin glifo propio usan el de la mayúscula.
+ */
+static const unsigned char glifos[128] = {
+    ['0'] = DS_A | DS_B | DS_C | DS_D | DS_E | DS_F,
+    ['1'] = DS_B | DS_C,
+    ['2'] = DS_A | DS_B | DS_D | DS_E | DS_G,
+    ['3'] = DS_A | DS_B | DS_C | DS_D | DS_G,
+    ['4'] = DS_B | DS_C | DS_F | DS_G,
+    ['5'] = DS_A | DS_C | DS_D | DS_F | DS_G,
+    ['6'] = DS_A | DS_C | DS_D | DS_E | DS_F | DS_G,
+    ['7'] = DS_A | DS_B | DS_C,
+    ['8'] = DS_A | DS_B | DS_C | DS_D | DS_E | DS_F | DS_G,
+    ['9'] = DS_A | DS_B | DS_C | DS_D | DS_F | DS_G,
+
+    ['A'] = DS_A | DS_B | DS_C | DS_E | DS_F | DS_G,
+    ['B'] = DS_C | DS_D | DS_E | DS_F | DS_G,
+    ['C'] = DS_A | DS_D | DS_E | DS_F,
+    ['D'] = DS_B | DS_C | DS_D | DS_E | DS_G,
+    ['E'] = DS_A | DS_D | DS_E | DS_F | DS_G,
+    ['F'] = DS_A | DS_E | DS_F | DS_G,
+    ['G'] = DS_A | DS_C | DS_D | DS_E | DS_F,
+    ['H'] = DS_B | DS_C | DS_E | DS_F | DS_G,
+    ['I'] = DS_E | DS_F,
+    ['J'] = DS_B | DS_C | DS_D | DS_E,
+    ['K'] = DS_A | DS_C | DS_E | DS_F | DS_G,
+    ['L'] = DS_D | DS_E | DS_F,
+    ['M'] = DS_A | DS_C | DS_E,
+    ['N'] = DS_A | DS_B | DS_C | DS_E | DS_F,
+    ['O'] = DS_A | DS_B | DS_C | DS_D | DS_E | DS_F,
+    ['P'] = DS_A | DS_B | DS_E | DS_F | DS_G,
+    ['Q'] = DS_A | DS_B | DS_C | DS_F | DS_G,
+    ['R'] = DS_E | DS_G,
+    ['S'] = DS_A | DS_C | DS_D | DS_F | DS_G,
+    ['T'] = DS_D | DS_E | DS_F | DS_G,
+    ['U'] = DS_B | DS_C | DS_D | DS_E | DS_F,
+    ['V'] = DS_C | DS_D | DS_E | DS_F,
+    ['W'] = DS_B | DS_D | DS_F,
+    ['X'] = DS_B | DS_C | DS_E | DS_F | DS_G,
+    ['Y'] = DS_B | DS_C | DS_D | DS_F | DS_G,
+    ['Z'] = DS_A | DS_B | DS_D | DS_E | DS_G,
+
+    ['a'] = DS_A | DS_B | DS_C | DS_E | DS_F | DS_G,
+    ['c'] = DS_D | DS_E | DS_G,
+    ['h'] = DS_C | DS_E | DS_F | DS_G,
+    ['i'] = DS_C,
+    ['n'] = DS_C | DS_E | DS_G,
+    ['o'] = DS_C | DS_D | DS_E | DS_G,
+    ['u'] = DS_C | DS_D | DS_E,
+
+    ['-'] = DS_G,
+    ['_'] = DS_D,
+    ['='] = DS_D | DS_G,
+    ['"'] = DS_B | DS_F,
+    ['\''] = DS_B,
+    ['['] = DS_A | DS_D | DS_E | DS_F,
+    [']'] = DS_A | DS_B | DS_C | DS_D,
+    ['('] = DS_A | DS_D | DS_E | DS_F,
+    [')'] = DS_A | DS_B | DS_C | DS_D,
+    ['?'] = DS_A | DS_B | DS_E | DS_G,
+    ['/'] = DS_B | DS_E | DS_G,
+    ['\\'] = DS_C | DS_F | DS_G,
+    ['|'] = DS_E | DS_F,
+    ['^'] = DS_A | DS_B | DS_F,
+    ['*'] = DS_A | DS_B | DS_F | DS_G, // Símbolo de grados
+};
+
+/* Traduce un carácter a segmentos; -1 si no es representable */
+static int char_to_segments(unsigned char c)
+{
+    if (c >= ARRAY_SIZE(glifos))
+        return -1;
+    if (c == ' ')
+        return 0;
+    if (!glifos[c] && c >= 'a' && c <= 'z')
+        c -= 32;
+    return glifos[c] ? glifos[c] : -1;
+}
+
+/*
+ * Convierte texto en glifos. Un '.' o ',' enciende el punto decimal del
+ * carácter anterior; si no hay anterior o ya lo tiene, ocupa su propio
+ * dígito. Devuelve el nº de glifos o -EINVAL (también si no hay texto).
+ */
+static int texto_a_segmentos(const unsigned char *texto, int len, unsigned char *segs)
+{
+    int i, n = 0, seg;
+
+    if (len < 1)
+        return -EINVAL;
+
+    for (i = 0; i < len; i++) {
+        if (texto[i] == '.' || texto[i] == ',') {
+            if (n > 0 && !(segs[n - 1] & DS_DP))
+                segs[n - 1] |= DS_DP;
+            else
+                segs[n++] = DS_DP;
+        } else if ((seg = char_to_segments(texto[i])) < 0) {
+            return -EINVAL;
+        } else {
+            segs[n++] = seg;
+        }
+    }
+    return n;
+}
+
+static int traducir_digito(const unsigned char *texto, int len, unsigned char *segs)
+{
+    if (len != 1 || !isxdigit(texto[0]))
+        return -EINVAL;
+    segs[0] = char_to_segments(texto[0]);
+    return 1;
+}
+
+/* Orden en que "secuencia" recorre los segmentos */
+static const unsigned char secuencia[] = { DS_D, DS_E, DS_F, DS_A, DS_B, DS_C, DS_G, DS_DP };
+static atomic_t paso_secuencia = ATOMIC_INIT(0);
+
+static int traducir_secuencia(const unsigned char *texto, int len, unsigned char *segs)
+{
+    unsigned int paso = atomic_inc_return(&paso_secuencia) - 1;
+
+    segs[0] = secuencia[paso % ARRAY_SIZE(secuencia)];
+    return 1;
+}
+
+const struct display7s_frontend display7s_frontend_secuencia = {
+    .nombre = "secuencia",
+    .traducir = traducir_secuencia,
+    .scroll = false,
+};
+
+const struct display7s_frontend display7s_frontend_digito = {
+    .nombre = "digito",
+    .traducir = traducir_digito,
+    .scroll = false,
+};
+
+const struct display7s_frontend display7s_frontend_multi = {
+    .nombre = "multi",
+    .traducir = texto_a_segmentos,
+    .scroll = false,
+};
+
+const struct display7s_frontend display7s_frontend_texto = {
+    .nombre = "texto",
+    .traducir = texto_a_segmentos,
+    .scroll = true,
+};
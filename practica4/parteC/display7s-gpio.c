@@ -0,0 +1,148 @@
+/*
+ * display7s-gpio.c
+ *
+ * Transportes por GPIO del display: "gpio" mueve una línea en cada paso
+ * (como los antiguos drivers de la práctica 3) y "gpio_array" cambia a la vez las
+ * parejas de líneas que lo permiten con gpiod_set_array_value().
+ */
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/gpio.h>
+#include <linux/delay.h>
+#include "display7s-core.h"
+
+/* GPIOs del display */
+enum {
+    SDI_IDX = 0,
+    RCLK_IDX,
+    SRCLK_IDX,
+    NR_GPIO_DISPLAY
+};
+static int display_gpio[NR_GPIO_DISPLAY] = {18, 23, 24};
+module_param_array(display_gpio, int, NULL, 0444);
+MODULE_PARM_DESC(display_gpio, "GPIOs SDI,RCLK,SRCLK del 74HC595");
+static struct gpio_desc *gpio_descriptors[NR_GPIO_DISPLAY];
+
+/*
+ * Tiempos del 74HC595 (hoja de datos, peor caso a 2 V): setup de SDI
+ * antes del flanco de SRCLK y anchura mínima de pulso de SRCLK/RCLK.
+ */
+static unsigned int t_setup_ns = 100;
+module_param(t_setup_ns, uint, 0644);
+MODULE_PARM_DESC(t_setup_ns, "Setup de SDI antes de SRCLK (ns)");
+
+static unsigned int t_pulso_ns = 100;
+module_param(t_pulso_ns, uint, 0644);
+MODULE_PARM_DESC(t_pulso_ns, "Anchura de pulso de SRCLK y RCLK (ns)");
+
+/*
+ * Pares de líneas que cambian a la vez: SDI se cambia junto con el flanco
+ * de bajada de SRCLK (el dato se captura en el de subida, así que el hold
+ * ya se cumplió) y RCLK sube junto con la última bajada de SRCLK.
+ */
+static struct gpio_desc *desc_dato[2];  // {SDI, SRCLK}
+static struct gpio_desc *desc_latch[2]; // {SRCLK, RCLK}
+
+static int iniciar_gpio(void)
+{
+    int i, err;
+
+    for (i = 0; i < NR_GPIO_DISPLAY; i++) {
+        if ((err = gpio_request(display_gpio[i], "display7s"))) {
+            while (--i >= 0)
+                gpio_free(display_gpio[i]);
+            return err;
+        }
+        gpio_descriptors[i] = gpio_to_desc(display_gpio[i]);
+        gpiod_direction_output(gpio_descriptors[i], 0);
+    }
+
+    desc_dato[0] = gpio_descriptors[SDI_IDX];
+    desc_dato[1] = gpio_descriptors[SRCLK_IDX];
+    desc_latch[0] = gpio_descriptors[SRCLK_IDX];
+    desc_latch[1] = gpio_descriptors[RCLK_IDX];
+    return 0;
+}
+
+static void liberar_gpio(void)
+{
+    int i;
+
+    for (i = 0; i < NR_GPIO_DISPLAY; i++)
+        gpio_free(display_gpio[i]);
+}
+
+/* Transporte "gpio": una línea en cada paso */
+static void enviar_gpio(const unsigned char *data, int n)
+{
+    int i, j;
+
+    gpiod_set_value(gpio_descriptors[RCLK_IDX], 0);
+
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < SEGMENT_COUNT; j++) {
+            gpiod_set_value(gpio_descriptors[SRCLK_IDX], 0);
+            gpiod_set_value(gpio_descriptors[SDI_IDX], (data[i] & (0x80 >> j)) ? 1 : 0);
+            ndelay(t_setup_ns);
+            gpiod_set_value(gpio_descriptors[SRCLK_IDX], 1);
+            ndelay(t_pulso_ns);
+        }
+    }
+
+    gpiod_set_value(gpio_descriptors[SRCLK_IDX], 0);
+    gpiod_set_value(gpio_descriptors[RCLK_IDX], 1);
+    ndelay(t_pulso_ns);
+    gpiod_set_value(gpio_descriptors[RCLK_IDX], 0);
+}
+
+/* Transporte "gpio_array": las parejas de líneas cambian en una sola llamada */
+static inline void set_display_pair(struct gpio_desc **descs, int v0, int v1)
+{
+    unsigned long valores = v0 | (v1 << 1);
+
+    gpiod_set_array_value(2, descs, NULL, &valores);
+}
+
+/* Desplaza un byte (MSB primero) sin hacer latch */
+static void shift_byte_7sdisplay(unsigned char data)
+{
+    int i;
+
+    for (i = 0; i < SEGMENT_COUNT; i++) {
+        set_display_pair(desc_dato, (data & (0x80 >> i)) ? 1 : 0, 0);
+        ndelay(t_setup_ns);
+        gpiod_set_value(gpio_descriptors[SRCLK_IDX], 1);
+        ndelay(t_pulso_ns);
+    }
+}
+
+static void enviar_gpio_array(const unsigned char *data, int n)
+{
+    int i;
+
+    set_display_pair(desc_latch, 0, 0);
+
+    for (i = 0; i < n; i++)
+        shift_byte_7sdisplay(data[i]);
+
+    set_display_pair(desc_latch, 0, 1);
+    ndelay(t_pulso_ns);
+    gpiod_set_value(gpio_descriptors[RCLK_IDX], 0);
+}
+
+/* Ninguno de los dos duerme: sirven igual desde el worker y desde un hrtimer */
+const struct display7s_transporte display7s_transporte_gpio = {
+    .nombre = "gpio",
+    .iniciar = iniciar_gpio,
+    .liberar = liberar_gpio,
+    .enviar = enviar_gpio,
+    .enviar_atomico = enviar_gpio,
+};
+
+const struct display7s_transporte display7s_transporte_gpio_array = {
+    .nombre = "gpio_array",
+    .iniciar = iniciar_gpio,
+    .liberar = liberar_gpio,
+    .enviar = enviar_gpio_array,
+    .enviar_atomico = enviar_gpio_array,
+};
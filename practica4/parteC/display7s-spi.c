@@ -0,0 +1,326 @@
+/*
+ * display7s-spi.c
+ *
+ * Transporte "spi" del display: MOSI -> SDI, SCLK -> SRCLK y CE -> RCLK
+ * (el 74HC595 hace el latch con la subida de CE al final de la
+ * transferencia). El driver se asocia a un dispositivo SPI "display7s",
+ * bien desde device tree (compatible "ucm,display7s", ver
+ * display7s-overlay.dts) o con driver_override. Mientras no haya ninguno,
+ * o si una transferencia falla, los cuadros se descartan; con
+ * spi_respaldo=1 salen por el transporte gpio_array, cuyas líneas se
+ * reservan entonces al cargar el módulo.
+ */
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/spi/spi.h>
+#include <linux/slab.h>
+#include <linux/delay.h>
+#include <linux/ktime.h>
+#include <linux/of.h>
+#include <linux/mutex.h>
+#include <linux/sched/signal.h>
+#include "display7s-core.h"
+
+static unsigned int spi_velocidad_hz = 0;
+module_param(spi_velocidad_hz, uint, 0444);
+MODULE_PARM_DESC(spi_velocidad_hz, "Frecuencia de SCLK (0 = la del dispositivo)");
+
+static bool spi_loop = false;
+module_param(spi_loop, bool, 0444);
+MODULE_PARM_DESC(spi_loop, "Activar SPI_LOOP en el controlador (para autotest_spi)");
+
+static bool spi_respaldo = false;
+module_param(spi_respaldo, bool, 0444);
+MODULE_PARM_DESC(spi_respaldo, "Usar gpio_array (reservando sus GPIOs) cuando no haya SPI");
+
+static const struct display7s_transporte *respaldo = &display7s_transporte_gpio_array;
+
+static struct spi_device *display_spi = NULL;
+static DEFINE_MUTEX(spi_mutex);           // Serializa probe, remove y autotest_spi
+static DEFINE_SPINLOCK(spi_lock);         // Protege display_spi y spi_ocupado
+static unsigned char *spi_buf;            // Buffer DMA del worker
+static unsigned char *spi_async_buf;      // Buffer DMA del hrtimer
+static struct spi_transfer spi_async_xfer;
+static struct spi_message spi_async_msg;
+static bool spi_ocupado = false;          // Hay una transferencia asíncrona en curso
+static u64 spi_transferencias = 0;
+static u64 spi_ranuras_perdidas = 0;      // Refrescos saltados con el bus ocupado
+static u64 spi_descartados = 0;           // Cuadros sin SPI ni respaldo
+
+/* Sin dispositivo SPI o con la transferencia fallida */
+static void enviar_sin_spi(const unsigned char *data, int n, bool atomico)
+{
+    unsigned long flags;
+
+    if (spi_respaldo) {
+        if (atomico)
+            respaldo->enviar_atomico(data, n);
+        else
+            respaldo->enviar(data, n);
+        return;
+    }
+    spin_lock_irqsave(&spi_lock, flags);
+    spi_descartados++;
+    spin_unlock_irqrestore(&spi_lock, flags);
+}
+
+/* Saca n bytes por el display desde contexto de proceso */
+static void enviar_spi(const unsigned char *data, int n)
+{
+    struct spi_device *spi = READ_ONCE(display_spi);
+
+    if (spi) {
+        memcpy(spi_buf, data, n);
+        if (spi_write(spi, spi_buf, n) == 0) {
+            spin_lock_irq(&spi_lock);
+            spi_transferencias++;
+            spin_unlock_irq(&spi_lock);
+            return;
+        }
+    }
+    enviar_sin_spi(data, n, false);
+}
+
+static void spi_async_completado(void *contexto)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&spi_lock, flags);
+    spi_ocupado = false;
+    spi_transferencias++;
+    spin_unlock_irqrestore(&spi_lock, flags);
+}
+
+/* Saca n bytes por el display sin dormir (desde el hrtimer) */
+static void enviar_spi_atomico(const unsigned char *data, int n)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&spi_lock, flags);
+    if (display_spi) {
+        if (spi_ocupado) {
+            spi_ranuras_perdidas++;
+        } else {
+            memcpy(spi_async_buf, data, n);
+            spi_async_xfer.len = n;
+            spi_ocupado = true;
+            if (spi_async(display_spi, &spi_async_msg))
+                spi_ocupado = false;
+        }
+        spin_unlock_irqrestore(&spi_lock, flags);
+        return;
+    }
+    spin_unlock_irqrestore(&spi_lock, flags);
+
+    enviar_sin_spi(data, n, true);
+}
+
+static int display7s_spi_probe(struct spi_device *spi)
+{
+    unsigned long flags;
+    int err;
+
+    /* Solo hay un display: los buffers y display_spi son globales */
+    mutex_lock(&spi_mutex);
+    if (display_spi) {
+        dev_warn(&spi->dev, "display7s: ya asociado a %s\n", dev_name(&display_spi->dev));
+        err = -EBUSY;
+        goto out;
+    }
+
+    spi->mode = SPI_MODE_0 | (spi_loop ? SPI_LOOP : 0);
+    spi->bits_per_word = 8;
+    if (spi_velocidad_hz)
+        spi->max_speed_hz = spi_velocidad_hz;
+    if ((err = spi_setup(spi)))
+        goto out;
+
+    spi_buf = devm_kzalloc(&spi->dev, MAX_DIGITOS, GFP_KERNEL);
+    spi_async_buf = devm_kzalloc(&spi->dev, MAX_DIGITOS, GFP_KERNEL);
+    if (!spi_buf || !spi_async_buf) {
+        err = -ENOMEM;
+        goto out;
+    }
+
+    spi_async_xfer.tx_buf = spi_async_buf;
+    spi_message_init_with_transfers(&spi_async_msg, &spi_async_xfer, 1);
+    spi_async_msg.complete = spi_async_completado;
+
+    spin_lock_irqsave(&spi_lock, flags);
+    display_spi = spi;
+    spin_unlock_irqrestore(&spi_lock, flags);
+
+    dev_info(&spi->dev, "display7s: usando SPI a %u Hz\n", spi->max_speed_hz);
+out:
+    mutex_unlock(&spi_mutex);
+    return err;
+}
+
+static void display7s_spi_remove(struct spi_device *spi)
+{
+    unsigned long flags;
+    bool ocupado;
+
+    /* Con spi_mutex tomado no puede haber un autotest en marcha */
+    mutex_lock(&spi_mutex);
+    spin_lock_irqsave(&spi_lock, flags);
+    display_spi = NULL;
+    spin_unlock_irqrestore(&spi_lock, flags);
+    mutex_unlock(&spi_mutex);
+
+    /* Esperar a que el worker y la última transferencia asíncrona terminen */
+    display7s_esperar_worker();
+    do {
+        spin_lock_irqsave(&spi_lock, flags);
+        ocupado = spi_ocupado;
+        spin_unlock_irqrestore(&spi_lock, flags);
+        if (ocupado)
+            msleep(1);
+    } while (ocupado);
+}
+
+static const struct spi_device_id display7s_spi_ids[] = {
+    { "display7s", 0 },
+    { }
+};
+MODULE_DEVICE_TABLE(spi, display7s_spi_ids);
+
+static const struct of_device_id display7s_of_ids[] = {
+    { .compatible = "ucm,display7s" },
+    { }
+};
+MODULE_DEVICE_TABLE(of, display7s_of_ids);
+
+static struct spi_driver display7s_spi_driver = {
+    .driver = {
+        .name = "display7s",
+        .of_match_table = display7s_of_ids,
+    },
+    .probe = display7s_spi_probe,
+    .remove = display7s_spi_remove,
+    .id_table = display7s_spi_ids,
+};
+
+static int iniciar_spi(void)
+{
+    int err;
+
+    if (spi_respaldo && (err = respaldo->iniciar()))
+        return err;
+    if ((err = spi_register_driver(&display7s_spi_driver)) && spi_respaldo)
+        respaldo->liberar();
+    return err;
+}
+
+static void liberar_spi(void)
+{
+    spi_unregister_driver(&display7s_spi_driver);
+    if (spi_respaldo)
+        respaldo->liberar();
+}
+
+static int estadisticas_spi(char *buf, int len)
+{
+    spin_lock_irq(&spi_lock);
+    len += sysfs_emit_at(buf, len, "spi=%s transferencias=%llu ranuras_perdidas=%llu descartados=%llu\n",
+                         display_spi ? dev_name(&display_spi->dev) : "ninguno",
+                         spi_transferencias, spi_ranuras_perdidas, spi_descartados);
+    spin_unlock_irq(&spi_lock);
+    return len;
+}
+
+/*
+ * Autotest del transporte SPI: echo N > /sys/class/misc/display7s/autotest_spi
+ * hace N transferencias full-duplex de num_digitos bytes y compara lo
+ * recibido con lo enviado (MOSI unido a MISO, o spi_loop=1 si el
+ * controlador lo soporta). El resultado se lee del mismo fichero.
+ * N está acotado porque spi_mutex (y con él remove()) queda retenido
+ * durante todo el test; un kill del escritor también lo corta.
+ */
+#define AUTOTEST_MAX_TRANSFERENCIAS 100000
+
+static unsigned int autotest_transferencias = 0;
+static unsigned int autotest_errores = 0;
+static u64 autotest_ns = 0;
+
+static ssize_t autotest_spi_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    u64 por_segundo = autotest_ns ?
+        div64_u64((u64)autotest_transferencias * NSEC_PER_SEC, autotest_ns) : 0;
+
+    return sysfs_emit(buf, "transferencias=%u errores=%u transferencias_s=%llu\n",
+                      autotest_transferencias, autotest_errores, por_segundo);
+}
+
+static ssize_t autotest_spi_store(struct device *dev, struct device_attribute *attr,
+                                  const char *buf, size_t count)
+{
+    struct spi_device *spi;
+    int digitos = display7s_num_digitos();
+    struct spi_transfer t = { .len = digitos };
+    unsigned char *tx, *rx;
+    unsigned int n, i, j, errores = 0;
+    u64 t0;
+    int err;
+
+    if ((err = kstrtouint(buf, 10, &n)))
+        return err;
+    if (n > AUTOTEST_MAX_TRANSFERENCIAS)
+        return -EINVAL;
+
+    tx = kmalloc(MAX_DIGITOS, GFP_KERNEL);
+    rx = kmalloc(MAX_DIGITOS, GFP_KERNEL);
+    if (!tx || !rx) {
+        err = -ENOMEM;
+        goto out;
+    }
+
+    /* remove() espera a que termine el autotest antes de soltar el dispositivo */
+    if ((err = mutex_lock_interruptible(&spi_mutex)))
+        goto out;
+    if (!(spi = display_spi)) {
+        mutex_unlock(&spi_mutex);
+        err = -ENODEV;
+        goto out;
+    }
+    t.tx_buf = tx;
+    t.rx_buf = rx;
+
+    t0 = ktime_get_ns();
+    for (i = 0; i < n && !fatal_signal_pending(current); i++) {
+        for (j = 0; j < digitos; j++)
+            tx[j] = i + j;
+        if (spi_sync_transfer(spi, &t, 1) || memcmp(tx, rx, digitos))
+            errores++;
+    }
+    autotest_ns = ktime_get_ns() - t0;
+    autotest_transferencias = i;
+    autotest_errores = errores;
+    mutex_unlock(&spi_mutex);
+
+out:
+    kfree(tx);
+    kfree(rx);
+    return err ? err : count;
+}
+static DEVICE_ATTR_RW(autotest_spi);
+
+static struct attribute *spi_attrs[] = {
+    &dev_attr_autotest_spi.attr,
+    NULL,
+};
+
+static const struct attribute_group spi_grupo = {
+    .attrs = spi_attrs,
+};
+
+const struct display7s_transporte display7s_transporte_spi = {
+    .nombre = "spi",
+    .iniciar = iniciar_spi,
+    .liberar = liberar_spi,
+    .enviar = enviar_spi,
+    .enviar_atomico = enviar_spi_atomico,
+    .estadisticas = estadisticas_spi,
+    .atributos = &spi_grupo,
+};
+
@@ -0,0 +1,40 @@
+/*
+ * display7s.h
+ *
+ * Interfaz compartida entre el driver drv7seg-smp y los programas de
+ * usuario que reproducen animaciones en /dev/display7s.
+ *
+ * Una animación es un vector de cuadros; cada cuadro trae los segmentos de
+ * todos los dígitos (de izquierda a derecha, solo se usan los num_digitos
+ * primeros) y el tiempo que permanece en el display. El driver la reproduce
+ * desde un hrtimer con plazos absolutos, así que los retrasos de un cuadro
+ * no se acumulan en los siguientes. Cualquier write() la detiene.
+ */
+#ifndef DISPLAY7S_H
+#define DISPLAY7S_H
+
+#include <linux/types.h>
+#include <linux/ioctl.h>
+
+#define DISPLAY7S_MAX_DIGITOS 8
+#define DISPLAY7S_MAX_CUADROS 1024
+
+struct display7s_cuadro {
+    __u8 segmentos[DISPLAY7S_MAX_DIGITOS]; // Bits DS_A..DS_DP por dígito
+    __u32 duracion_us;                     // > 0
+};
+
+struct display7s_animacion {
+    __u64 cuadros;       // Puntero a struct display7s_cuadro[num_cuadros]
+    __u32 num_cuadros;   // 1..DISPLAY7S_MAX_CUADROS
+    __u32 repeticiones;  // Vueltas completas; 0 = en bucle hasta parar
+};
+
+#define DISPLAY7S_IOC_MAGIC 'd'
+
+/* Sustituye la animación en curso (si la hay) y empieza a reproducir */
+#define DISPLAY7S_IOC_ANIMAR _IOW(DISPLAY7S_IOC_MAGIC, 1, struct display7s_animacion)
+/* Detiene la animación dejando el último cuadro en el display */
+#define DISPLAY7S_IOC_PARAR  _IO(DISPLAY7S_IOC_MAGIC, 2)
+
+#endif /* DISPLAY7S_H */
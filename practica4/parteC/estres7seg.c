@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+/*
+ * Prueba de estrés del modelo de apertura compartida de /dev/display7s:
+ * muchos procesos abren, escriben unas pocas veces y cierran en bucle
+ * durante un tiempo fijo. Si algún proceso no termina a tiempo se da por
+ * bloqueado el driver. Al final muestra aperturas y escrituras por segundo
+ * y las estadísticas del driver (que no deben listar ningún escritor).
+ *
+ * Uso: ./estres7seg [num_procesos] [segundos] [escrituras_por_apertura]
+ */
+#define MAX_PROCESOS 256
+#define MARGEN_BLOQUEO 10 // Segundos extra antes de declarar un bloqueo
+
+struct contadores {
+    long aperturas;
+    long escrituras;
+    long errores;
+};
+
+static int num_procesos = 32;
+static int segundos = 10;
+static int escrituras_por_apertura = 4;
+static struct contadores *resultados; // Compartido con los hijos
+
+static double ahora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void escritor(int id) {
+    const char characters[] = "0123456789abcdef";
+    struct contadores *c = &resultados[id];
+    double fin = ahora() + segundos;
+    char buffer[3];
+    int fd, i;
+
+    while (ahora() < fin) {
+        fd = open("/dev/display7s", O_WRONLY);
+        if (fd == -1) {
+            c->errores++;
+            continue;
+        }
+        c->aperturas++;
+        for (i = 0; i < escrituras_por_apertura; i++) {
+            snprintf(buffer, sizeof(buffer), "%c\n", characters[(id + i) % 16]);
+            if (write(fd, buffer, 2) == 2)
+                c->escrituras++;
+            else
+                c->errores++;
+        }
+        close(fd);
+    }
+    exit(EXIT_SUCCESS);
+}
+
+static void mostrar_fichero(const char *ruta) {
+    char linea[256];
+    FILE *f = fopen(ruta, "r");
+
+    if (!f)
+        return;
+    while (fgets(linea, sizeof(linea), f))
+        printf("  %s", linea);
+    fclose(f);
+}
+
+int main(int argc, char *argv[]) {
+    pid_t hijos[MAX_PROCESOS];
+    struct contadores total = {0};
+    double t0, t1, limite;
+    int vivos, estado, bloqueo = 0;
+
+    if (argc > 1)
+        num_procesos = atoi(argv[1]);
+    if (argc > 2)
+        segundos = atoi(argv[2]);
+    if (argc > 3)
+        escrituras_por_apertura = atoi(argv[3]);
+    if (num_procesos < 1 || num_procesos > MAX_PROCESOS) {
+        fprintf(stderr, "num_procesos debe estar entre 1 y %d\n", MAX_PROCESOS);
+        return EXIT_FAILURE;
+    }
+
+    resultados = mmap(NULL, sizeof(struct contadores) * num_procesos, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (resultados == MAP_FAILED) {
+        perror("mmap");
+        return EXIT_FAILURE;
+    }
+
+    t0 = ahora();
+    for (int i = 0; i < num_procesos; i++) {
+        hijos[i] = fork();
+        if (hijos[i] == -1) {
+            perror("fork");
+            return EXIT_FAILURE;
+        }
+        if (hijos[i] == 0)
+            escritor(i);
+    }
+
+    /* Esperar a los hijos sin bloquearse indefinidamente */
+    limite = t0 + segundos + MARGEN_BLOQUEO;
+    vivos = num_procesos;
+    while (vivos > 0) {
+        pid_t pid = waitpid(-1, &estado, WNOHANG);
+        if (pid > 0) {
+            vivos--;
+        } else if (ahora() > limite) {
+            bloqueo = 1;
+            break;
+        } else {
+            usleep(10000);
+        }
+    }
+    t1 = ahora();
+
+    for (int i = 0; i < num_procesos; i++) {
+        total.aperturas += resultados[i].aperturas;
+        total.escrituras += resultados[i].escrituras;
+        total.errores += resultados[i].errores;
+    }
+
+    printf("%d procesos, %d s: %ld aperturas (%.0f/s), %ld escrituras (%.0f/s), %ld errores\n",
+           num_procesos, segundos, total.aperturas, total.aperturas / (t1 - t0),
+           total.escrituras, total.escrituras / (t1 - t0), total.errores);
+    printf("driver:\n");
+    mostrar_fichero("/sys/class/misc/display7s/estadisticas");
+    mostrar_fichero("/sys/class/misc/display7s/escritores");
+
+    if (bloqueo) {
+        fprintf(stderr, "FALLO: %d procesos siguen dentro del driver tras %d s\n",
+                vivos, segundos + MARGEN_BLOQUEO);
+        for (int i = 0; i < num_procesos; i++)
+            kill(hijos[i], SIGKILL);
+        return EXIT_FAILURE;
+    }
+    return total.errores ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+/*
+ * Mide la latencia de write() vista por los escritores cuando muchos hilos
+ * escriben a la vez en /dev/display7s. Todos los hilos comparten el mismo
+ * descriptor. Al terminar muestra las estadísticas de fusión del driver.
+ *
+ * Uso: ./latencia7seg [num_hilos] [escrituras_por_hilo]
+ */
+#define MAX_HILOS 256
+
+struct resultado {
+    double media_us;
+    double max_us;
+};
+
+static int fd;
+static int num_hilos = 16;
+static long escrituras_por_hilo = 10000;
+static struct resultado resultados[MAX_HILOS];
+
+static double ahora_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+void *escritor(void *arg) {
+    const char characters[] = "0123456789abcdef";
+    int id = *(int *)arg;
+    char buffer[3];
+    double t0, dt, total = 0, max = 0;
+
+    for (long i = 0; i < escrituras_por_hilo; i++) {
+        snprintf(buffer, sizeof(buffer), "%c\n", characters[(i + id) % 16]);
+        t0 = ahora_us();
+        if (write(fd, buffer, 2) == -1) {
+            perror("Error al escribir en el dispositivo");
+            pthread_exit(NULL);
+        }
+        dt = ahora_us() - t0;
+        total += dt;
+        if (dt > max)
+            max = dt;
+    }
+
+    resultados[id].media_us = total / escrituras_por_hilo;
+    resultados[id].max_us = max;
+    pthread_exit(NULL);
+}
+
+int main(int argc, char *argv[]) {
+    pthread_t threads[MAX_HILOS];
+    int thread_ids[MAX_HILOS];
+    double media = 0, max = 0;
+    char estadisticas[128];
+    FILE *f;
+
+    if (argc > 1)
+        num_hilos = atoi(argv[1]);
+    if (argc > 2)
+        escrituras_por_hilo = atol(argv[2]);
+    if (num_hilos < 1 || num_hilos > MAX_HILOS) {
+        fprintf(stderr, "num_hilos debe estar entre 1 y %d\n", MAX_HILOS);
+        return EXIT_FAILURE;
+    }
+
+    fd = open("/dev/display7s", O_WRONLY);
+    if (fd == -1) {
+        perror("Error al abrir el dispositivo");
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 0; i < num_hilos; i++) {
+        thread_ids[i] = i;
+        if (pthread_create(&threads[i], NULL, escritor, &thread_ids[i]) != 0) {
+            perror("Error al crear el hilo");
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (int i = 0; i < num_hilos; i++) {
+        pthread_join(threads[i], NULL);
+        media += resultados[i].media_us / num_hilos;
+        if (resultados[i].max_us > max)
+            max = resultados[i].max_us;
+    }
+    close(fd);
+
+    printf("%d hilos x %ld escrituras: latencia media %.2f us, maxima %.2f us\n",
+           num_hilos, escrituras_por_hilo, media, max);
+
+    f = fopen("/sys/class/misc/display7s/estadisticas", "r");
+    if (f && fgets(estadisticas, sizeof(estadisticas), f))
+        printf("driver: %s", estadisticas);
+    if (f)
+        fclose(f);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,39 @@
+#!/bin/bash
+
+# Comprueba el refresco multiplexado de 4 dígitos sobre un chip GPIO
+# simulado: nº de refrescos en la ventana de medida y coste por refresco.
+# Uso (como root, desde este directorio): ./prueba_multiplexado.sh [refresco_hz]
+
+source ../../practica3/TestBee/gpio_simulado.sh
+
+HZ_REFRESCO=${1:-100}
+DIGITOS=4
+SEGUNDOS=5
+ESTADISTICAS=/sys/class/misc/display7s/estadisticas
+
+base=$(gpio_simulado_crear 8) || exit 1
+rmmod drv7seg-smp 2>/dev/null
+insmod drv7seg-smp.ko display_gpio=$(gpio_simulado_lineas $base 3) \
+    num_digitos=$DIGITOS multiplexado=1 refresco_hz=$HZ_REFRESCO || exit 1
+
+echo "12ab" > /dev/display7s
+
+campo() { grep -o "$1=[0-9]*" $ESTADISTICAS | cut -d= -f2; }
+
+r0=$(campo refrescos)
+sleep $SEGUNDOS
+r1=$(campo refrescos)
+cat $ESTADISTICAS
+
+rmmod drv7seg-smp
+gpio_simulado_destruir
+
+esperados=$(( HZ_REFRESCO * DIGITOS * SEGUNDOS ))
+obtenidos=$(( r1 - r0 ))
+# Se admite un 2% de desviación por la lectura no atómica de la ventana
+if [ $(( obtenidos * 100 )) -lt $(( esperados * 98 )) ] || \
+   [ $(( obtenidos * 100 )) -gt $(( esperados * 102 )) ]; then
+    echo "FALLO: $obtenidos refrescos, se esperaban $esperados"
+    exit 1
+fi
+echo "OK: $obtenidos refrescos en $SEGUNDOS s (esperados $esperados)"
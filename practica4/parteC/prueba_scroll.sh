@@ -0,0 +1,45 @@
+#!/bin/bash
+
+# Comprueba el scroll de texto en un display de 4 dígitos sobre un chip
+# GPIO simulado: nº de pasos del timer en la ventana de medida frente a los
+# esperados según scroll_ms, y que una escritura corta lo detiene.
+# Uso (como root, desde este directorio): ./prueba_scroll.sh [scroll_ms]
+
+source ../../practica3/TestBee/gpio_simulado.sh
+
+MS=${1:-100}
+SEGUNDOS=5
+ESTADISTICAS=/sys/class/misc/display7s/estadisticas
+
+base=$(gpio_simulado_crear 3) || exit 1
+rmmod drv7seg-smp 2>/dev/null
+insmod drv7seg-smp.ko display_gpio=$(gpio_simulado_lineas $base 3) \
+    num_digitos=4 scroll_ms=$MS || exit 1
+
+campo() { grep -o "$1=[0-9]*" $ESTADISTICAS | cut -d= -f2; }
+
+fallo=0
+echo "Hola. 3,14 = Pi [ok]" > /dev/display7s || fallo=1
+echo "€" > /dev/display7s 2>/dev/null && { echo "FALLO: se aceptó un carácter no representable"; fallo=1; }
+
+p0=$(campo pasos_scroll)
+sleep $SEGUNDOS
+p1=$(campo pasos_scroll)
+
+echo "8.8.8.8." > /dev/display7s || fallo=1
+grep -q "scroll=parado" $ESTADISTICAS || { echo "FALLO: el scroll sigue activo"; fallo=1; }
+cat $ESTADISTICAS
+
+rmmod drv7seg-smp
+gpio_simulado_destruir
+
+esperados=$(( SEGUNDOS * 1000 / MS ))
+obtenidos=$(( p1 - p0 ))
+# Los timers de jiffies se redondean hacia arriba: se admite un 10%
+if [ $(( obtenidos * 100 )) -lt $(( esperados * 90 )) ] || \
+   [ $obtenidos -gt $(( esperados + 1 )) ]; then
+    echo "FALLO: $obtenidos pasos de scroll, se esperaban $esperados"
+    fallo=1
+fi
+[ $fallo -eq 0 ] && echo "OK: $obtenidos pasos en $SEGUNDOS s (esperados $esperados)"
+exit $fallo
@@ -0,0 +1,42 @@
+#!/bin/bash
+
+# Prueba del backend SPI del display: asocia el driver a un dispositivo SPI
+# existente (spi0.0 por defecto), comprueba en bucle cerrado que los bytes
+# enviados vuelven intactos y mide transferencias por segundo.
+# Necesita MOSI unido a MISO con un cable, o un controlador que soporte
+# SPI_LOOP (entonces se puede pasar spi_loop=1 en LOOP=1).
+# Uso (como root, desde este directorio): ./prueba_spi.sh [spiB.C] [transferencias]
+# (transferencias <= 100000, el límite de autotest_spi)
+
+DISPOSITIVO=${1:-spi0.0}
+N=${2:-10000}
+SYSFS=/sys/bus/spi/devices/$DISPOSITIVO
+AUTOTEST=/sys/class/misc/display7s/autotest_spi
+ESTADISTICAS=/sys/class/misc/display7s/estadisticas
+
+[ -d $SYSFS ] || { echo "No existe $SYSFS"; exit 1; }
+
+rmmod drv7seg-smp 2>/dev/null
+insmod drv7seg-smp.ko transporte=spi num_digitos=4 spi_loop=${LOOP:-0} || exit 1
+
+# Quitar el driver actual (p.ej. spidev) y asociar display7s
+anterior=$(basename "$(readlink $SYSFS/driver)" 2>/dev/null)
+[ -n "$anterior" ] && echo $DISPOSITIVO > $SYSFS/driver/unbind
+echo display7s > $SYSFS/driver_override
+echo $DISPOSITIVO > /sys/bus/spi/drivers/display7s/bind || exit 1
+
+echo $N > $AUTOTEST || { rmmod drv7seg-smp; exit 1; }
+resultado=$(cat $AUTOTEST)
+echo "$resultado"
+
+# Unas cuantas escrituras normales por el camino SPI
+for i in $(seq 0 99); do printf "%04x\n" $i > /dev/display7s; done
+sleep 0.1
+cat $ESTADISTICAS
+
+rmmod drv7seg-smp
+echo > $SYSFS/driver_override
+[ -n "$anterior" ] && echo $DISPOSITIVO > /sys/bus/spi/drivers/$anterior/bind
+
+echo "$resultado" | grep -q "errores=0 " || { echo "FALLO: bytes corruptos en el bucle SPI"; exit 1; }
+echo OK
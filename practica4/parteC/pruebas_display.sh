@@ -0,0 +1,86 @@
+#!/bin/bash
+
+# Batería común del driver de display sobre un chip GPIO simulado. Prueba
+# cada combinación de transporte por GPIO y frontend comprobando el cuadro
+# que llega al transporte (/sys/class/misc/display7s/cuadro), y después
+# lanza las pruebas de multiplexado y scroll.
+# Uso (como root, desde este directorio): ./pruebas_display.sh
+
+source ../../practica3/TestBee/gpio_simulado.sh
+
+CUADRO=/sys/class/misc/display7s/cuadro
+fallos=0
+
+base=$(gpio_simulado_crear 3) || exit 1
+rmmod drv7seg-smp 2>/dev/null
+
+cargar() {
+    insmod drv7seg-smp.ko display_gpio=$(gpio_simulado_lineas $base 3) "$@" || exit 1
+}
+
+# espera <texto> <cuadro esperado>: la escritura debe aceptarse y dar ese cuadro
+espera() {
+    if ! echo "$1" > /dev/display7s 2>/dev/null; then
+        echo "FALLO [$combinacion]: se rechazó '$1'"
+        fallos=$((fallos + 1))
+        return
+    fi
+    sleep 0.05
+    if [ "$(cat $CUADRO)" != "$2" ]; then
+        echo "FALLO [$combinacion]: '$1' dio '$(cat $CUADRO)', se esperaba '$2'"
+        fallos=$((fallos + 1))
+    fi
+}
+
+# rechaza <texto>: la escritura debe fallar
+rechaza() {
+    if echo "$1" > /dev/display7s 2>/dev/null; then
+        echo "FALLO [$combinacion]: se aceptó '$1'"
+        fallos=$((fallos + 1))
+    fi
+}
+
+for transporte in gpio gpio_array; do
+    combinacion="$transporte/secuencia"
+    cargar transporte=$transporte frontend=secuencia num_digitos=1
+    espera "" "10"
+    espera "x" "08"
+    for i in {1..6}; do echo > /dev/display7s; done
+    espera "" "10"
+    rmmod drv7seg-smp
+
+    combinacion="$transporte/digito"
+    cargar transporte=$transporte frontend=digito num_digitos=1
+    espera 7 "e0"
+    espera b "3e"
+    rechaza g
+    rechaza 12
+    rmmod drv7seg-smp
+
+    combinacion="$transporte/multi"
+    cargar transporte=$transporte frontend=multi num_digitos=4
+    espera 12 "00 00 60 da"
+    espera 8. "00 00 00 ff"
+    espera "Hola" "6e 3a 1c ee"
+    rechaza ""
+    rechaza 12345
+    rmmod drv7seg-smp
+
+    combinacion="$transporte/texto"
+    cargar transporte=$transporte frontend=texto num_digitos=4
+    espera "-1.5" "00 02 61 b6"
+    espera "Hola" "6e 3a 1c ee"
+    echo "un texto largo" > /dev/display7s || { echo "FALLO [$combinacion]: scroll rechazado"; fallos=$((fallos + 1)); }
+    grep -q "scroll=activo" /sys/class/misc/display7s/estadisticas || \
+        { echo "FALLO [$combinacion]: no arrancó el scroll"; fallos=$((fallos + 1)); }
+    rechaza "€"
+    rmmod drv7seg-smp
+done
+
+gpio_simulado_destruir
+
+./prueba_multiplexado.sh || fallos=$((fallos + 1))
+./prueba_scroll.sh || fallos=$((fallos + 1))
+
+[ $fallos -eq 0 ] && echo "OK: todas las pruebas del display" || echo "$fallos fallos"
+exit $fallos
@@ -0,0 +1,159 @@
+/*
+ * botones.c
+ *
+ * Varios pulsadores expuestos como un dispositivo de entrada estándar
+ * ("botones"). Cada GPIO de button_gpio tiene su propia IRQ y su propio
+ * antirrebote (el común de la práctica 5), y se notifica como la tecla de
+ * la misma posición en codigos. La marca de tiempo de cada evento es la del
+ * primer flanco tomada en la mitad superior, no la de cuando se entrega.
+ *
+ * Desde espacio de usuario se lee con evdev (/dev/input/eventN, read(),
+ * poll/epoll) o con evtest.
+ */
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/gpio.h>
+#include <linux/input.h>
+#include <linux/interrupt.h>
+#include <linux/mutex.h>
+#include "antirrebote.h"
+
+#define MAX_BOTONES 8
+
+static int button_gpio[MAX_BOTONES] = {22};
+static int num_botones = 1;
+module_param_array(button_gpio, int, &num_botones, 0444);
+MODULE_PARM_DESC(button_gpio, "GPIOs de los pulsadores");
+
+static int codigos[MAX_BOTONES] = {BTN_0, BTN_1, BTN_2, BTN_3, BTN_4, BTN_5, BTN_6, BTN_7};
+static int num_codigos = 0;
+module_param_array(codigos, int, &num_codigos, 0444);
+MODULE_PARM_DESC(codigos, "Código de tecla de cada pulsador (por defecto BTN_0, BTN_1...)");
+
+static unsigned int debounce_us = 20000;
+module_param(debounce_us, uint, 0444);
+MODULE_PARM_DESC(debounce_us, "Tiempo que un pulsador debe estar estable para contar una pulsación/liberación (us)");
+
+struct boton {
+    struct antirrebote ar;
+    struct gpio_desc *desc;
+    unsigned int codigo;
+    char nombre[16];
+};
+
+static struct boton botones[MAX_BOTONES];
+static struct input_dev *entrada;
+static DEFINE_MUTEX(entrada_lock); // Marca de tiempo + tecla + sync, sin mezclar botones
+
+/* Hilo de la interrupción de cada botón: un evento ya sin rebotes */
+static void evento_boton(struct antirrebote *ar, const struct antirrebote_evento *ev)
+{
+    struct boton *b = container_of(ar, struct boton, ar);
+
+    if (ev->tipo == ANTIRREBOTE_LARGA)
+        return;
+
+    /* Los hilos de IRQ de distintos botones pueden correr a la vez */
+    mutex_lock(&entrada_lock);
+    input_set_timestamp(entrada, ns_to_ktime(ev->t_ns));
+    input_report_key(entrada, b->codigo, ev->tipo == ANTIRREBOTE_PULSACION);
+    input_sync(entrada);
+    mutex_unlock(&entrada_lock);
+}
+
+static void liberar_botones(int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        gpiod_put(botones[i].desc);
+}
+
+static int __init botones_init(void)
+{
+    int i, n_gpio = 0, n_irq = 0;
+    int err;
+
+    if (num_codigos && num_codigos != num_botones) {
+        pr_err("botones: codigos debe tener tantos elementos como button_gpio\n");
+        return -EINVAL;
+    }
+
+    for (i = 0; i < num_botones; i++) {
+        struct boton *b = &botones[i];
+
+        if (codigos[i] <= 0 || codigos[i] > KEY_MAX) {
+            pr_err("botones: código %d no válido\n", codigos[i]);
+            err = -EINVAL;
+            goto err_gpio;
+        }
+        b->codigo = codigos[i];
+        snprintf(b->nombre, sizeof(b->nombre), "boton_%d", i);
+
+        if ((err = gpio_request(button_gpio[i], b->nombre))) {
+            pr_err("botones: GPIO %d request\n", button_gpio[i]);
+            goto err_gpio;
+        }
+        if (!(b->desc = gpio_to_desc(button_gpio[i]))) {
+            pr_err("botones: GPIO %d is not valid\n", button_gpio[i]);
+            gpio_free(button_gpio[i]);
+            err = -EINVAL;
+            goto err_gpio;
+        }
+        n_gpio++;
+        gpiod_direction_input(b->desc);
+    }
+
+    entrada = input_allocate_device();
+    if (!entrada) {
+        err = -ENOMEM;
+        goto err_gpio;
+    }
+    entrada->name = "botones";
+    entrada->phys = "botones/input0";
+    entrada->id.bustype = BUS_HOST;
+    for (i = 0; i < num_botones; i++)
+        input_set_capability(entrada, EV_KEY, botones[i].codigo);
+
+    if ((err = input_register_device(entrada))) {
+        input_free_device(entrada);
+        goto err_gpio;
+    }
+
+    /* Las IRQ al final: evento_boton() ya puede usar el dispositivo */
+    for (i = 0; i < num_botones; i++) {
+        if ((err = antirrebote_iniciar(&botones[i].ar, botones[i].desc, debounce_us, 0,
+                                       evento_boton, botones[i].nombre))) {
+            pr_err("botones: cannot register IRQ for GPIO %d\n", button_gpio[i]);
+            goto err_irq;
+        }
+        n_irq++;
+    }
+
+    pr_info("botones: %d pulsadores registrados\n", num_botones);
+    return 0;
+
+err_irq:
+    for (i = 0; i < n_irq; i++)
+        antirrebote_parar(&botones[i].ar);
+    input_unregister_device(entrada);
+err_gpio:
+    liberar_botones(n_gpio);
+    return err;
+}
+
+static void __exit botones_exit(void)
+{
+    int i;
+
+    for (i = 0; i < num_botones; i++)
+        antirrebote_parar(&botones[i].ar);
+    input_unregister_device(entrada);
+    liberar_botones(num_botones);
+}
+
+module_init(botones_init);
+module_exit(botones_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("Pulsadores como dispositivo de entrada (evdev)");
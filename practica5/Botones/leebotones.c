@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <linux/input.h>
+
+/*
+ * Lector al estilo de evtest para el dispositivo de entrada "botones": espera
+ * con epoll y por cada tecla imprime
+ *
+ *   <t_evento_ns> <codigo> <valor> <latencia_ns>
+ *
+ * con t_evento_ns la marca del kernel (CLOCK_MONOTONIC, primer flanco) y
+ * latencia_ns lo que tardó en llegar aquí. Termina tras num_eventos teclas o
+ * tras espera_ms sin eventos.
+ *
+ * Uso: ./leebotones [num_eventos] [espera_ms] [/dev/input/eventN]
+ */
+static int abrir_botones(void)
+{
+    glob_t g;
+    char nombre[64], ruta[80];
+    FILE *f;
+    int fd = -1;
+
+    if (glob("/sys/class/input/event*/device/name", 0, NULL, &g) != 0)
+        return -1;
+    for (size_t i = 0; i < g.gl_pathc && fd == -1; i++) {
+        f = fopen(g.gl_pathv[i], "r");
+        if (!f)
+            continue;
+        if (fgets(nombre, sizeof(nombre), f) && strcmp(nombre, "botones\n") == 0) {
+            /* /sys/class/input/eventN/device/name -> /dev/input/eventN */
+            sscanf(g.gl_pathv[i], "/sys/class/input/%31[^/]", nombre);
+            snprintf(ruta, sizeof(ruta), "/dev/input/%s", nombre);
+            fd = open(ruta, O_RDONLY | O_NONBLOCK);
+        }
+        fclose(f);
+    }
+    globfree(&g);
+    return fd;
+}
+
+static long long ahora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int main(int argc, char *argv[]) {
+    long num_eventos = argc > 1 ? atol(argv[1]) : -1;
+    int espera_ms = argc > 2 ? atoi(argv[2]) : -1;
+    int reloj = CLOCK_MONOTONIC;
+    struct epoll_event ev = { .events = EPOLLIN }, listo;
+    struct input_event eventos[16];
+    long leidos = 0;
+    long long t, llegada;
+    int fd, ep, n;
+
+    fd = argc > 3 ? open(argv[3], O_RDONLY | O_NONBLOCK) : abrir_botones();
+    if (fd == -1) {
+        perror("No se encuentra el dispositivo botones");
+        return EXIT_FAILURE;
+    }
+    /* Marcas en el mismo reloj que ktime_get_ns() */
+    if (ioctl(fd, EVIOCSCLOCKID, &reloj) == -1) {
+        perror("EVIOCSCLOCKID");
+        return EXIT_FAILURE;
+    }
+
+    ep = epoll_create1(0);
+    ev.data.fd = fd;
+    if (ep == -1 || epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        perror("epoll");
+        return EXIT_FAILURE;
+    }
+
+    while (num_eventos < 0 || leidos < num_eventos) {
+        n = epoll_wait(ep, &listo, 1, espera_ms);
+        if (n == -1) {
+            perror("epoll_wait");
+            return EXIT_FAILURE;
+        }
+        if (n == 0)
+            break;
+
+        n = read(fd, eventos, sizeof(eventos));
+        llegada = ahora_ns();
+        for (int i = 0; i < n / (int)sizeof(eventos[0]); i++) {
+            if (eventos[i].type != EV_KEY)
+                continue;
+            t = eventos[i].input_event_sec * 1000000000LL + eventos[i].input_event_usec * 1000LL;
+            printf("%lld %u %d %lld\n", t, eventos[i].code, eventos[i].value, llegada - t);
+            leidos++;
+        }
+        fflush(stdout);
+    }
+
+    close(ep);
+    close(fd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,62 @@
+#!/bin/bash
+
+# Prueba de extremo a extremo de botones.ko sobre un chip GPIO simulado:
+# pulsa cada botón varias veces (con rebotes) y comprueba con leebotones que
+# por evdev llega exactamente una pulsación y una liberación por vez, con el
+# código de ese botón, y resume la latencia primer flanco -> lector.
+# Uso (como root, desde este directorio): ./prueba_botones.sh [botones] [pulsaciones]
+
+source ../../practica3/TestBee/gpio_simulado.sh
+
+BOTONES=${1:-4}
+PULSACIONES=${2:-20}
+REBOTES=3
+BTN_0=256 # Códigos por defecto: BTN_0, BTN_1...
+
+make -s leebotones || exit 1
+
+base=$(gpio_simulado_crear $BOTONES) || exit 1
+rmmod botones 2>/dev/null
+insmod botones.ko button_gpio=$(gpio_simulado_lineas $base $BOTONES) debounce_us=5000 || exit 1
+sleep 0.2 # udev crea /dev/input/eventN
+
+salida=$(mktemp)
+./leebotones $((BOTONES * PULSACIONES * 2)) 2000 > $salida &
+lector=$!
+sleep 0.1
+
+for i in $(seq $PULSACIONES); do
+    for b in $(seq 0 $((BOTONES - 1))); do
+        for v in 1 0; do
+            for r in $(seq $REBOTES); do
+                gpio_simulado_poner $b $v
+                gpio_simulado_poner $b $((1 - v))
+            done
+            gpio_simulado_poner $b $v
+            sleep 0.02
+        done
+    done
+done
+
+wait $lector
+rmmod botones
+gpio_simulado_destruir
+
+awk -v botones=$BOTONES -v esperadas=$PULSACIONES -v btn0=$BTN_0 '
+    { cuenta[$2 - btn0, $3]++; s += $4; if ($4 > max) max = $4 }
+    END {
+        for (b = 0; b < botones; b++) {
+            printf "boton %d: pulsaciones=%d liberaciones=%d (esperadas %d)\n",
+                   b, cuenta[b, 1], cuenta[b, 0], esperadas
+            if (cuenta[b, 1] != esperadas || cuenta[b, 0] != esperadas)
+                fallo = 1
+        }
+        if (NR != 2 * botones * esperadas)
+            fallo = 1
+        if (NR) printf "latencia primer flanco->lector media=%.0f ns max=%d ns\n", s / NR, max
+        exit fallo
+    }' $salida
+ret=$?
+[ $ret -eq 0 ] && echo OK || echo FALLO
+rm -f $salida
+exit $ret
@@ -0,0 +1,223 @@
+/*
+ * antirrebote.h
+ *
+ * Antirrebote por tiempo para un pulsador, común a los drivers de la
+ * práctica 5. Cada línea tiene una pequeña máquina de estados movida por un
+ * hrtimer:
+ *
+ *   - la mitad superior de la interrupción (ambos flancos) solo apunta la
+ *     hora del primer flanco y cuenta flancos, y reinicia el hrtimer con la
+ *     ventana de antirrebote;
+ *   - cuando pasan ventana_us sin flancos, el hrtimer lee el nivel ya
+ *     estable: si cambió respecto al último estado estable genera una
+ *     pulsación o una liberación, y si no, los flancos eran ruido. Así los
+ *     rebotes se absorben en vez de descartarse a ciegas;
+ *   - mientras el botón sigue pulsado, el mismo hrtimer se rearma hasta
+ *     larga_ms después de la pulsación para generar una pulsación larga.
+ *
+ * El hrtimer deja los eventos en un anillo sin cerrojos (él es el único
+ * productor) y despierta al hilo de la interrupción, que llama a la función
+ * del driver en contexto de proceso.
+ *
+ * El nivel se lee desde el hrtimer, así que la línea no puede dormir
+ * (GPIO de la Raspberry Pi o gpio-mockup).
+ */
+#ifndef ANTIRREBOTE_H
+#define ANTIRREBOTE_H
+
+#include <linux/kernel.h>
+#include <linux/gpio/consumer.h>
+#include <linux/hrtimer.h>
+#include <linux/interrupt.h>
+#include <linux/ktime.h>
+#include <linux/spinlock.h>
+#include <asm/barrier.h>
+
+enum antirrebote_tipo {
+    ANTIRREBOTE_PULSACION,
+    ANTIRREBOTE_LIBERACION,
+    ANTIRREBOTE_LARGA,
+};
+
+static const char *const antirrebote_nombres[] = {
+    [ANTIRREBOTE_PULSACION] = "pulsacion",
+    [ANTIRREBOTE_LIBERACION] = "liberacion",
+    [ANTIRREBOTE_LARGA] = "larga",
+};
+
+struct antirrebote_evento {
+    enum antirrebote_tipo tipo;
+    u64 t_ns;              // Primer flanco (pulsación/liberación) o vencimiento (larga)
+    unsigned int flancos;  // Flancos absorbidos por este evento
+};
+
+struct antirrebote;
+typedef void (*antirrebote_fn)(struct antirrebote *ar, const struct antirrebote_evento *ev);
+
+#define ANTIRREBOTE_EVENTOS 16 // Potencia de 2
+
+struct antirrebote {
+    /* Configuración */
+    struct gpio_desc *desc;
+    int irq;
+    unsigned int ventana_us;
+    unsigned int larga_ms;   // 0 = sin pulsación larga
+    antirrebote_fn fn;
+
+    /* Compartido entre la mitad superior y el hrtimer */
+    spinlock_t lock;
+    u64 t_primer_flanco;
+    unsigned int flancos;
+
+    /* Solo del hrtimer */
+    struct hrtimer timer;
+    bool pulsado;            // Último estado estable
+    bool larga_emitida;
+    u64 t_pulsacion;
+    unsigned long ruido;     // Ráfagas de flancos que no cambiaron el estado
+
+    /* Anillo hrtimer -> hilo */
+    struct antirrebote_evento eventos[ANTIRREBOTE_EVENTOS];
+    unsigned int cabeza, cola;
+    unsigned long perdidos;
+};
+
+static void antirrebote_encolar(struct antirrebote *ar, enum antirrebote_tipo tipo,
+                                u64 t_ns, unsigned int flancos)
+{
+    unsigned int cabeza = ar->cabeza;
+    struct antirrebote_evento *ev;
+
+    if (cabeza - smp_load_acquire(&ar->cola) == ANTIRREBOTE_EVENTOS) {
+        ar->perdidos++;
+        return;
+    }
+    ev = &ar->eventos[cabeza & (ANTIRREBOTE_EVENTOS - 1)];
+    ev->tipo = tipo;
+    ev->t_ns = t_ns;
+    ev->flancos = flancos;
+    smp_store_release(&ar->cabeza, cabeza + 1);
+}
+
+/* Mitad superior: solo marca de tiempo y reinicio de la ventana */
+static irqreturn_t antirrebote_irq(int irq, void *dev_id)
+{
+    struct antirrebote *ar = dev_id;
+    u64 t = ktime_get_ns();
+
+    spin_lock(&ar->lock);
+    if (ar->flancos++ == 0)
+        ar->t_primer_flanco = t;
+    spin_unlock(&ar->lock);
+
+    hrtimer_start(&ar->timer, us_to_ktime(READ_ONCE(ar->ventana_us)), HRTIMER_MODE_REL);
+    return IRQ_HANDLED;
+}
+
+/* hrtimer: la línea lleva ventana_us estable, o vence la pulsación larga */
+static enum hrtimer_restart antirrebote_timer_fn(struct hrtimer *timer)
+{
+    struct antirrebote *ar = container_of(timer, struct antirrebote, timer);
+    bool nivel = gpiod_get_value(ar->desc) > 0;
+    u64 ahora = ktime_get_ns(), larga_ns, t0;
+    unsigned int n;
+    bool despertar = false;
+
+    spin_lock(&ar->lock);
+    t0 = ar->t_primer_flanco;
+    n = ar->flancos;
+    ar->flancos = 0;
+    spin_unlock(&ar->lock);
+
+    if (nivel != ar->pulsado) {
+        ar->pulsado = nivel;
+        antirrebote_encolar(ar, nivel ? ANTIRREBOTE_PULSACION : ANTIRREBOTE_LIBERACION, t0, n);
+        despertar = true;
+        if (nivel) {
+            ar->t_pulsacion = t0;
+            ar->larga_emitida = false;
+        }
+    } else if (n) {
+        ar->ruido++;
+    }
+
+    if (ar->pulsado && ar->larga_ms && !ar->larga_emitida) {
+        larga_ns = (u64)ar->larga_ms * NSEC_PER_MSEC;
+        if (ahora - ar->t_pulsacion >= larga_ns) {
+            antirrebote_encolar(ar, ANTIRREBOTE_LARGA, ahora, 0);
+            ar->larga_emitida = true;
+            despertar = true;
+        } else {
+            if (despertar)
+                irq_wake_thread(ar->irq, ar);
+            hrtimer_forward_now(timer, ns_to_ktime(ar->t_pulsacion + larga_ns - ahora));
+            return HRTIMER_RESTART;
+        }
+    }
+
+    if (despertar)
+        irq_wake_thread(ar->irq, ar);
+    return HRTIMER_NORESTART;
+}
+
+/* Hilo de la interrupción: entrega los eventos al driver */
+static irqreturn_t antirrebote_hilo(int irq, void *dev_id)
+{
+    struct antirrebote *ar = dev_id;
+    struct antirrebote_evento ev;
+    unsigned int cola;
+
+    for (;;) {
+        cola = ar->cola;
+        if (smp_load_acquire(&ar->cabeza) == cola)
+            break;
+        ev = ar->eventos[cola & (ANTIRREBOTE_EVENTOS - 1)];
+        smp_store_release(&ar->cola, cola + 1);
+        ar->fn(ar, &ev);
+    }
+    return IRQ_HANDLED;
+}
+
+/*
+ * Empieza a vigilar desc, que ya debe estar configurada como entrada. El
+ * estado inicial es el nivel actual. fn se llama en el hilo de la
+ * interrupción, donde se puede dormir.
+ */
+static int antirrebote_iniciar(struct antirrebote *ar, struct gpio_desc *desc,
+                               unsigned int ventana_us, unsigned int larga_ms,
+                               antirrebote_fn fn, const char *nombre)
+{
+    int irq = gpiod_to_irq(desc);
+
+    if (irq < 0)
+        return irq;
+
+    ar->desc = desc;
+    ar->irq = irq;
+    ar->ventana_us = ventana_us;
+    ar->larga_ms = larga_ms;
+    ar->fn = fn;
+    spin_lock_init(&ar->lock);
+    ar->flancos = 0;
+    ar->pulsado = gpiod_get_value(desc) > 0;
+    ar->larga_emitida = true;
+    ar->cabeza = ar->cola = 0;
+    hrtimer_init(&ar->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    ar->timer.function = antirrebote_timer_fn;
+
+    /*
+     * Sin IRQF_ONESHOT: la línea no se enmascara mientras corre el hilo,
+     * así que ningún flanco se pierde.
+     */
+    return request_threaded_irq(irq, antirrebote_irq, antirrebote_hilo,
+                                IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING, nombre, ar);
+}
+
+static void antirrebote_parar(struct antirrebote *ar)
+{
+    disable_irq(ar->irq);
+    hrtimer_cancel(&ar->timer);
+    free_irq(ar->irq, ar);
+}
+
+#endif /* ANTIRREBOTE_H */
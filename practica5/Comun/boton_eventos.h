@@ -0,0 +1,145 @@
+/*
+ * boton_eventos.h
+ *
+ * Registro de eventos del pulsador legible desde /dev/<nombre>. Cada evento
+ * es una línea de texto:
+ *
+ *   <t_irq_ns> <latencia_ns> <pulsacion|liberacion|larga> <flancos>
+ *
+ * donde t_irq_ns es la marca de ktime_get_ns() del primer flanco tomada en
+ * la mitad superior (el vencimiento, en una pulsación larga), latencia_ns el
+ * tiempo hasta que el driver terminó de actuar, ventana de antirrebote
+ * incluida, y flancos los flancos que absorbió el antirrebote para dar este
+ * evento. read() se bloquea hasta que hay eventos, salvo con O_NONBLOCK. Si
+ * nadie lee, los más antiguos se pierden.
+ */
+#ifndef BOTON_EVENTOS_H
+#define BOTON_EVENTOS_H
+
+#include <linux/kernel.h>
+#include <linux/fs.h>
+#include <linux/kfifo.h>
+#include <linux/ktime.h>
+#include <linux/miscdevice.h>
+#include <linux/spinlock.h>
+#include <linux/uaccess.h>
+#include <linux/wait.h>
+#include "antirrebote.h"
+
+#define BOTON_EVENTOS_TAM 256 // Potencia de 2
+
+struct boton_evento {
+    u64 t_irq_ns;
+    u64 latencia_ns;
+    enum antirrebote_tipo tipo;
+    unsigned int flancos;
+};
+
+struct boton_eventos {
+    struct miscdevice misc;
+    DECLARE_KFIFO(fifo, struct boton_evento, BOTON_EVENTOS_TAM);
+    spinlock_t lock;             // Protege fifo y estadísticas
+    wait_queue_head_t espera;
+    u64 cuenta[ARRAY_SIZE(antirrebote_nombres)];
+    u64 rebotes;                 // Flancos absorbidos de más
+    u64 latencia_total_ns, latencia_max_ns;
+};
+
+/* Anota un evento del antirrebote una vez que el driver ha actuado */
+static void boton_eventos_publicar(struct boton_eventos *ev, const struct antirrebote_evento *a)
+{
+    struct boton_evento e = {
+        .t_irq_ns = a->t_ns,
+        .latencia_ns = ktime_get_ns() - a->t_ns,
+        .tipo = a->tipo,
+        .flancos = a->flancos,
+    };
+    unsigned long flags;
+
+    spin_lock_irqsave(&ev->lock, flags);
+    ev->cuenta[e.tipo]++;
+    if (e.flancos > 1)
+        ev->rebotes += e.flancos - 1;
+    if (e.tipo == ANTIRREBOTE_PULSACION) {
+        ev->latencia_total_ns += e.latencia_ns;
+        if (e.latencia_ns > ev->latencia_max_ns)
+            ev->latencia_max_ns = e.latencia_ns;
+    }
+    if (kfifo_is_full(&ev->fifo))
+        kfifo_skip(&ev->fifo);
+    kfifo_put(&ev->fifo, e);
+    spin_unlock_irqrestore(&ev->lock, flags);
+
+    wake_up_interruptible(&ev->espera);
+}
+
+static ssize_t boton_eventos_read(struct file *filp, char __user *buf, size_t len, loff_t *off)
+{
+    struct boton_eventos *ev = container_of(filp->private_data, struct boton_eventos, misc);
+    struct boton_evento e;
+    char linea[64];
+    size_t total = 0;
+    int n;
+
+    if (wait_event_interruptible(ev->espera, (filp->f_flags & O_NONBLOCK) ||
+                                              !kfifo_is_empty(&ev->fifo)))
+        return -ERESTARTSYS;
+
+    /* Tantas líneas completas como quepan en buf */
+    for (;;) {
+        spin_lock_irq(&ev->lock);
+        if (!kfifo_peek(&ev->fifo, &e)) {
+            spin_unlock_irq(&ev->lock);
+            break;
+        }
+        n = scnprintf(linea, sizeof(linea), "%llu %llu %s %u\n", e.t_irq_ns, e.latencia_ns,
+                      antirrebote_nombres[e.tipo], e.flancos);
+        if (total + n > len) {
+            spin_unlock_irq(&ev->lock);
+            break;
+        }
+        kfifo_skip(&ev->fifo);
+        spin_unlock_irq(&ev->lock);
+
+        if (copy_to_user(buf + total, linea, n))
+            return -EFAULT;
+        total += n;
+    }
+
+    if (total == 0)
+        return (filp->f_flags & O_NONBLOCK) ? -EAGAIN : -EINVAL;
+    return total;
+}
+
+static const struct file_operations boton_eventos_fops = {
+    .owner = THIS_MODULE,
+    .read = boton_eventos_read,
+};
+
+static int boton_eventos_registrar(struct boton_eventos *ev, const char *nombre)
+{
+    INIT_KFIFO(ev->fifo);
+    spin_lock_init(&ev->lock);
+    init_waitqueue_head(&ev->espera);
+
+    ev->misc.minor = MISC_DYNAMIC_MINOR;
+    ev->misc.name = nombre;
+    ev->misc.fops = &boton_eventos_fops;
+    ev->misc.mode = 0444;
+    return misc_register(&ev->misc);
+}
+
+static void boton_eventos_quitar(struct boton_eventos *ev)
+{
+    misc_deregister(&ev->misc);
+
+    pr_info("%s: pulsaciones=%llu liberaciones=%llu largas=%llu rebotes=%llu\n", ev->misc.name,
+            ev->cuenta[ANTIRREBOTE_PULSACION], ev->cuenta[ANTIRREBOTE_LIBERACION],
+            ev->cuenta[ANTIRREBOTE_LARGA], ev->rebotes);
+    if (ev->cuenta[ANTIRREBOTE_PULSACION])
+        pr_info("%s: latencia primer flanco->acción media=%llu ns max=%llu ns\n", ev->misc.name,
+                div64_u64(ev->latencia_total_ns, ev->cuenta[ANTIRREBOTE_PULSACION]),
+                ev->latencia_max_ns);
+}
+
+#endif /* BOTON_EVENTOS_H */
@@ -2,49 +2,67 @@
 #include <asm-generic/errno.h>
 #include <linux/gpio.h>
 #include <linux/interrupt.h>
-#include <linux/jiffies.h>
+#include <linux/ktime.h>
+#include "antirrebote.h"
+#include "boton_eventos.h"
 
 #define ALL_LEDS_ON 0x7
 #define ALL_LEDS_OFF 0
 
-#define MANUAL_DEBOUNCE
-
 #define NR_GPIO_LEDS  3
 
-const int led_gpio[NR_GPIO_LEDS] = {25, 27, 4};
+static int led_gpio[NR_GPIO_LEDS] = {25, 27, 4};
+module_param_array(led_gpio, int, NULL, 0444);
+MODULE_PARM_DESC(led_gpio, "LED GPIOs");
 
 /* Array to hold gpio descriptors */
 struct gpio_desc* gpio_descriptors[NR_GPIO_LEDS];
 
-#define GPIO_BUTTON 22
+static int button_gpio = 22;
+module_param(button_gpio, int, 0444);
+MODULE_PARM_DESC(button_gpio, "Button GPIO");
+
+static unsigned int debounce_us = 20000;
+module_param(debounce_us, uint, 0444);
+MODULE_PARM_DESC(debounce_us, "The button must be stable this long before a press/release counts (us)");
+
+static unsigned int long_press_ms = 1000;
+module_param(long_press_ms, uint, 0444);
+MODULE_PARM_DESC(long_press_ms, "Hold time for a long press, which turns the LEDs off (ms, 0 = disabled)");
+
 struct gpio_desc* desc_button = NULL;
-static int gpio_button_irqn = -1;
 static int led_state = ALL_LEDS_ON;
 
+/*
+ * Debouncing is done by the shared hrtimer state machine; its events reach
+ * button_event() in the IRQ thread and are logged to /dev/button_events.
+ */
+static struct antirrebote debounce;
+static struct boton_eventos events;
+
 
-/* Set led state to that specified by mask */
+/* Set led state to that specified by mask (all lines in one call) */
 static inline int set_pi_leds(unsigned int mask) {
-  int i;
-  for (i = 0; i < NR_GPIO_LEDS; i++)
-    gpiod_set_value(gpio_descriptors[i], (mask >> i) & 0x1 );
-  return 0;
+  unsigned long values = mask;
+  return gpiod_set_array_value_cansleep(NR_GPIO_LEDS, gpio_descriptors, NULL, &values);
 }
 
-/* Interrupt handler for button **/
-static irqreturn_t gpio_irq_handler(int irq, void *dev_id)
+/* Runs in the IRQ thread for every debounced event */
+static void button_event(struct antirrebote *ar, const struct antirrebote_evento *ev)
 {
-#ifdef MANUAL_DEBOUNCE
-  static unsigned long last_interrupt = 0;
-  unsigned long diff = jiffies - last_interrupt;
-  if (diff < 20)
-    return IRQ_HANDLED;
-
-  last_interrupt = jiffies;
-#endif
-
-  led_state = ~led_state & ALL_LEDS_ON;
-  set_pi_leds(led_state);
-  return IRQ_HANDLED;
+  switch (ev->tipo) {
+  case ANTIRREBOTE_PULSACION:
+    led_state = ~led_state & ALL_LEDS_ON;
+    set_pi_leds(led_state);
+    break;
+  case ANTIRREBOTE_LARGA:
+    led_state = ALL_LEDS_OFF;
+    set_pi_leds(led_state);
+    break;
+  default:
+    break;
+  }
+  boton_eventos_publicar(&events, ev);
 }
 
 
@@ -76,14 +94,14 @@ static int __init gpioint_init(void)
 
 
   /* Requesting Button's GPIO */
-  if ((err = gpio_request(GPIO_BUTTON, "button"))) {
-    pr_err("ERROR: GPIO %d request\n", GPIO_BUTTON);
+  if ((err = gpio_request(button_gpio, "button"))) {
+    pr_err("ERROR: GPIO %d request\n", button_gpio);
     goto err_handle;
   }
 
   /* Configure Button */
-  if (!(desc_button = gpio_to_desc(GPIO_BUTTON))) {
-    pr_err("GPIO %d is not valid\n", GPIO_BUTTON);
+  if (!(desc_button = gpio_to_desc(button_gpio))) {
+    pr_err("GPIO %d is not valid\n", button_gpio);
     err = -EINVAL;
     goto err_handle;
   }
@@ -94,27 +112,18 @@ static int __init gpioint_init(void)
   gpiod_direction_input(desc_button);
 
   /*
-  ** The lines below are commented because gpiod_set_debounce is not supported
-  ** in the Raspberry pi. Debounce is handled manually in this driver.
+  ** gpiod_set_debounce is not supported in the Raspberry pi. Debounce is
+  ** done in software by the shared antirrebote state machine.
   */
-#ifndef MANUAL_DEBOUNCE
-  //Debounce the button with a delay of 200ms
-  if (gpiod_set_debounce(desc_button, 200) < 0) {
-    pr_err("ERROR: gpio_set_debounce - %d\n", GPIO_BUTTON);
-    goto err_handle;
-  }
-#endif
 
-  //Get the IRQ number for our GPIO
-  gpio_button_irqn = gpiod_to_irq(desc_button);
-  pr_info("IRQ Number = %d\n", gpio_button_irqn);
+  if ((err = boton_eventos_registrar(&events, "button_events")))
+    goto err_handle;
 
-  if (request_irq(gpio_button_irqn,             //IRQ number
-                  gpio_irq_handler,   //IRQ handler
-                  IRQF_TRIGGER_RISING,        //Handler will be called in raising edge
-                  "button_leds",               //used to identify the device name using this IRQ
-                  NULL)) {                    //device id for shared IRQ
+  /* Requests the IRQ on both edges */
+  if ((err = antirrebote_iniciar(&debounce, desc_button, debounce_us, long_press_ms,
+                                 button_event, "button_leds"))) {
     pr_err("my_device: cannot register IRQ ");
+    boton_eventos_quitar(&events);
     goto err_handle;
   }
 
@@ -133,7 +142,8 @@ err_handle:
 static void __exit gpioint_exit(void) {
   int i = 0;
 
-  free_irq(gpio_button_irqn, NULL);
+  antirrebote_parar(&debounce);
+  boton_eventos_quitar(&events);
   set_pi_leds(ALL_LEDS_OFF);
   
   for (i = 0; i < NR_GPIO_LEDS; i++)
@@ -0,0 +1,52 @@
+#!/bin/bash
+
+# Latencia IRQ -> acción del pulsador sobre un chip GPIO simulado: inyecta
+# pulsaciones (cada una con unos rebotes) cambiando la entrada del botón y
+# resume lo leído de /dev/button_events. La latencia se mide desde el primer
+# flanco, así que incluye la ventana de antirrebote (debounce_us).
+# Uso (como root, desde este directorio): ./prueba_latencia.sh [pulsaciones] [rebotes]
+
+source ../../practica3/TestBee/gpio_simulado.sh
+
+PULSACIONES=${1:-50}
+REBOTES=${2:-3}
+EVENTOS=/dev/button_events
+BOTON=3 # Offset del botón en el chip simulado
+
+base=$(gpio_simulado_crear 4) || exit 1
+rmmod gpiod-interrupt 2>/dev/null
+insmod gpiod-interrupt.ko led_gpio=$(gpio_simulado_lineas $base 3) \
+    button_gpio=$((base + BOTON)) debounce_us=20000 || exit 1
+
+salida=$(mktemp)
+cat $EVENTOS > $salida &
+lector=$!
+
+for i in $(seq $PULSACIONES); do
+    # Pulsación y liberación, con rebotes muy por debajo de debounce_us
+    for r in $(seq 0 $REBOTES); do
+        gpio_simulado_poner $BOTON 1
+        gpio_simulado_poner $BOTON 0
+    done
+    gpio_simulado_poner $BOTON 1
+    sleep 0.05
+    gpio_simulado_poner $BOTON 0
+    sleep 0.05
+done
+sleep 0.2
+
+kill $lector
+rmmod gpiod-interrupt
+gpio_simulado_destruir
+
+awk -v esperadas=$PULSACIONES '
+    $3 == "pulsacion" { n++; s += $2; if ($2 > max) max = $2 }
+    $4 > 1 { r += $4 - 1 }
+    END {
+        printf "pulsaciones=%d (esperadas %d) rebotes absorbidos=%d\n", n, esperadas, r
+        if (n) printf "latencia primer flanco->accion media=%.0f ns max=%d ns\n", s / n, max
+        exit n != esperadas
+    }' $salida
+ret=$?
+rm -f $salida
+exit $ret
@@ -0,0 +1,73 @@
+#!/bin/bash
+
+# Prueba del antirrebote común sobre un chip GPIO simulado: cada pulsación
+# es un tren de rebotes al pulsar y otro al soltar, todos muy por debajo de
+# la ventana. Comprueba en /dev/button_events que sale exactamente una
+# pulsación y una liberación por cada una, que una pulsación mantenida da
+# una sola pulsación larga y que ninguna latencia (primer flanco -> acción)
+# pasa de la ventana más un margen.
+# Uso (como root, desde este directorio):
+#   ./prueba_rebotes.sh [pulsaciones] [rebotes] [ventana_us] [margen_us]
+
+source ../../practica3/TestBee/gpio_simulado.sh
+
+PULSACIONES=${1:-50}
+REBOTES=${2:-5}
+VENTANA_US=${3:-5000}
+MARGEN_US=${4:-10000}
+LARGA_MS=300
+EVENTOS=/dev/button_events
+BOTON=3 # Offset del botón en el chip simulado
+
+# Tren de rebotes que acaba en el nivel $1
+tren() {
+    local r
+    for r in $(seq $REBOTES); do
+        gpio_simulado_poner $BOTON $1
+        gpio_simulado_poner $BOTON $((1 - $1))
+    done
+    gpio_simulado_poner $BOTON $1
+}
+
+base=$(gpio_simulado_crear 4) || exit 1
+rmmod gpiod-interrupt 2>/dev/null
+insmod gpiod-interrupt.ko led_gpio=$(gpio_simulado_lineas $base 3) \
+    button_gpio=$((base + BOTON)) debounce_us=$VENTANA_US long_press_ms=$LARGA_MS || exit 1
+
+salida=$(mktemp)
+cat $EVENTOS > $salida &
+lector=$!
+
+for i in $(seq $PULSACIONES); do
+    tren 1
+    sleep 0.03
+    tren 0
+    sleep 0.03
+done
+
+# Una pulsación mantenida, con rebotes también mientras está pulsado
+tren 1
+sleep 0.1
+tren 1
+sleep $(awk "BEGIN { print ($LARGA_MS + 200) / 1000 }")
+tren 0
+sleep 0.1
+
+kill $lector
+rmmod gpiod-interrupt
+gpio_simulado_destruir
+
+awk -v n=$((PULSACIONES + 1)) -v limite=$(( (VENTANA_US + MARGEN_US) * 1000 )) '
+    { cuenta[$3]++ }
+    $3 != "larga" { m++; s += $2; if ($2 > max) max = $2; if ($2 > limite) lentos++ }
+    END {
+        printf "pulsaciones=%d liberaciones=%d largas=%d (esperadas %d/%d/1)\n",
+               cuenta["pulsacion"], cuenta["liberacion"], cuenta["larga"], n, n
+        printf "latencia media=%.0f ns max=%d ns (limite %d ns)\n", s / m, max, limite
+        exit cuenta["pulsacion"] != n || cuenta["liberacion"] != n ||
+             cuenta["larga"] != 1 || lentos > 0
+    }' $salida
+ret=$?
+[ $ret -eq 0 ] && echo OK || echo FALLO
+rm -f $salida
+exit $ret
@@ -0,0 +1,37 @@
+#!/bin/bash
+
+# Jitter y deriva del contador de timerleds en los dos modos sobre un chip
+# GPIO simulado. Por defecto mide un millón de periodos de 100 us en modo
+# hrtimer; el modo jiffies, que no baja del tick, con la décima parte de
+# periodos de 1 ms. Cambia además el periodo en marcha por sysfs.
+# Uso (como root, desde este directorio): ./medir_periodo.sh [periodos] [periodo_us]
+
+source ../../practica3/TestBee/gpio_simulado.sh
+
+PERIODOS=${1:-1000000}
+PERIODO_US=${2:-100}
+PARAMETROS=/sys/module/timerleds/parameters
+BOTON=3 # Offset del botón en el chip simulado
+
+base=$(gpio_simulado_crear 4) || exit 1
+
+medir() {
+    local modo=$1 periodo_us=$2
+    rmmod timerleds 2>/dev/null
+    insmod timerleds.ko modo=$modo timer_period_us=$periodo_us \
+        led_gpio=$(gpio_simulado_lineas $base 3) button_gpio=$((base + BOTON)) || exit 1
+    sleep $(awk "BEGIN { print $PERIODOS * $periodo_us / 1e6 + 0.5 }")
+    cat $PARAMETROS/estadisticas
+}
+
+medir hrtimer $PERIODO_US
+# Cambio de periodo en marcha: empieza una medida nueva
+echo $((PERIODO_US * 2)) > $PARAMETROS/timer_period_us
+sleep 1
+echo "tras timer_period_us=$(cat $PARAMETROS/timer_period_us):"
+cat $PARAMETROS/estadisticas
+
+PERIODOS=$((PERIODOS / 10)) medir jiffies 1000
+
+rmmod timerleds
+gpio_simulado_destruir
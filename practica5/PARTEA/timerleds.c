@@ -7,71 +7,389 @@
 #include <linux/jiffies.h>
 #include <linux/interrupt.h>
 #include <linux/moduleparam.h>
+#include <linux/ktime.h>
+#include <linux/hrtimer.h>
+#include "antirrebote.h"
+#include "boton_eventos.h"
+
+/*
+ * Periodo del contador. Se puede cambiar en marcha escribiendo en
+ * /sys/module/timerleds/parameters/timer_period_ms o timer_period_us, que
+ * son dos vistas del mismo valor.
+ */
+#define PERIODO_MIN_NS (10 * NSEC_PER_USEC) // Por debajo el hrtimer se come la CPU
+
+static u64 periodo_ns = 0;
+static unsigned int periodo_gen = 0; // Cambia con cada periodo nuevo
+
+static int periodo_set(const char *val, u64 unidad_ns)
+{
+    unsigned int v;
+    int err = kstrtouint(val, 0, &v);
 
-static int timer_period_ms = 0;
+    if (err)
+        return err;
+    if ((u64)v * unidad_ns < PERIODO_MIN_NS)
+        return -EINVAL;
+    WRITE_ONCE(periodo_ns, (u64)v * unidad_ns);
+    WRITE_ONCE(periodo_gen, periodo_gen + 1);
+    return 0;
+}
+
+static int periodo_ms_set(const char *val, const struct kernel_param *kp)
+{
+    return periodo_set(val, NSEC_PER_MSEC);
+}
+
+static int periodo_ms_get(char *buf, const struct kernel_param *kp)
+{
+    return sysfs_emit(buf, "%llu\n", div_u64(READ_ONCE(periodo_ns), NSEC_PER_MSEC));
+}
+
+static int periodo_us_set(const char *val, const struct kernel_param *kp)
+{
+    return periodo_set(val, NSEC_PER_USEC);
+}
 
-/* module_param(timer_period_ms, int, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH); */
- module_param(timer_period_ms, int, 0000);
+static int periodo_us_get(char *buf, const struct kernel_param *kp)
+{
+    return sysfs_emit(buf, "%llu\n", div_u64(READ_ONCE(periodo_ns), NSEC_PER_USEC));
+}
+
+static const struct kernel_param_ops periodo_ms_ops = {
+    .set = periodo_ms_set,
+    .get = periodo_ms_get,
+};
+static const struct kernel_param_ops periodo_us_ops = {
+    .set = periodo_us_set,
+    .get = periodo_us_get,
+};
+module_param_cb(timer_period_ms, &periodo_ms_ops, NULL, 0644);
 MODULE_PARM_DESC(timer_period_ms, "periodo del temporizador (ms)");
+module_param_cb(timer_period_us, &periodo_us_ops, NULL, 0644);
+MODULE_PARM_DESC(timer_period_us, "periodo del temporizador (us); submilisegundo solo con modo=hrtimer");
+
+/*
+ * jiffies: timer_list rearmado respecto al momento actual (resolución de
+ * un tick y deriva acumulada). hrtimer: plazos absolutos con
+ * hrtimer_forward, sin deriva y con periodos por debajo del tick.
+ */
+static char *modo = "jiffies";
+module_param(modo, charp, 0444);
+MODULE_PARM_DESC(modo, "jiffies o hrtimer");
+static bool modo_hrtimer = false;
 
 // LEDS
 #define NR_GPIO_LEDS 3
 #define ALL_LEDS_ON 0x7
 #define ALL_LEDS_OFF 0
-const int led_gpio[NR_GPIO_LEDS] = {25, 27, 4};
+static int led_gpio[NR_GPIO_LEDS] = {25, 27, 4};
+module_param_array(led_gpio, int, NULL, 0444);
+MODULE_PARM_DESC(led_gpio, "GPIOs de los LEDs");
 struct gpio_desc *gpio_descriptors[NR_GPIO_LEDS] = {NULL};
 int ledCounter = 0;
 static int led_state = 0;
 
 // BOTON
-#define MANUAL_DEBOUNCE
-#define GPIO_BUTTON 22
+static int button_gpio = 22;
+module_param(button_gpio, int, 0444);
+MODULE_PARM_DESC(button_gpio, "GPIO del pulsador");
+
+static unsigned int debounce_us = 20000;
+module_param(debounce_us, uint, 0444);
+MODULE_PARM_DESC(debounce_us, "Tiempo que el pulsador debe estar estable para contar una pulsación/liberación (us)");
+
+static unsigned int larga_ms = 1000;
+module_param(larga_ms, uint, 0444);
+MODULE_PARM_DESC(larga_ms, "Pulsación larga, que reinicia la cuenta (ms, 0 = desactivada)");
+
 struct gpio_desc *desc_button = NULL;
-static int gpio_button_irqn = -1;
+
+/*
+ * El antirrebote común (máquina de estados con hrtimer) entrega las
+ * pulsaciones ya filtradas a evento_boton() en el hilo de la interrupción,
+ * que para o reanuda el temporizador y las deja en /dev/timerleds_eventos.
+ */
+static struct antirrebote antirrebote;
+static struct boton_eventos eventos;
 
 static struct timer_list my_timer;
+static struct hrtimer my_hrtimer;
+
+/*
+ * Estado del contador. en_marcha manda: los callbacks del temporizador lo
+ * miran con estado_lock antes de tocar los LEDs y de rearmarse, así que
+ * tras pausar no se cuela ningún avance aunque el temporizador ya hubiera
+ * vencido. control_mutex serializa pausar/reanudar/paso, que vienen del
+ * botón (hilo de la IRQ) y de sysfs.
+ */
+static DEFINE_SPINLOCK(estado_lock);
+static DEFINE_MUTEX(control_mutex);
+static bool en_marcha = false;
+static u64 avances = 0;        // Avances hechos por el temporizador
+static u64 pasos = 0;          // Avances manuales ("step")
+static u64 perdidos_total = 0; // Periodos que no dieron avance por llegar tarde
+static u64 extra = 0;          // Vencimientos tras pausar, que no avanzan
+static bool listo = false;     // Hasta el final de init no se puede reanudar
+
+/*
+ * Medidas de cada periodo, las toca solo el callback del temporizador. El
+ * periodo k debería vencer en t0 + k * periodo:
+ *   - jitter: error de cada intervalo (t_k - t_k-1) respecto al periodo
+ *   - deriva: retraso acumulado del último periodo respecto a su plazo ideal
+ * Un cambio de periodo empieza una medida nueva.
+ */
+static struct {
+    unsigned int gen;
+    u64 periodo_ns;
+    u64 t0_ns, t_ultimo_ns;
+    u64 periodos;
+    u64 perdidos;            // Periodos saltados (solo hrtimer)
+    u64 jitter_total_ns, jitter_max_ns;
+    s64 deriva_ns;
+} medida;
+
+static void medir_periodo(u64 ahora, u64 saltados)
+{
+    u64 jitter;
+
+    if (medida.gen != READ_ONCE(periodo_gen) || medida.t0_ns == 0)
+    {
+        medida.gen = READ_ONCE(periodo_gen);
+        medida.periodo_ns = READ_ONCE(periodo_ns);
+        medida.t0_ns = medida.t_ultimo_ns = ahora;
+        medida.periodos = medida.perdidos = 0;
+        medida.jitter_total_ns = medida.jitter_max_ns = 0;
+        medida.deriva_ns = 0;
+        return;
+    }
 
+    jitter = abs((s64)(ahora - medida.t_ultimo_ns) - (s64)((saltados + 1) * medida.periodo_ns));
+    medida.periodos += saltados + 1;
+    medida.perdidos += saltados;
+    medida.jitter_total_ns += jitter;
+    if (jitter > medida.jitter_max_ns)
+        medida.jitter_max_ns = jitter;
+    medida.deriva_ns = (s64)(ahora - medida.t0_ns) - (s64)(medida.periodos * medida.periodo_ns);
+    medida.t_ultimo_ns = ahora;
+}
+
+/* /sys/module/timerleds/parameters/estadisticas (solo lectura) */
+static int estadisticas_get(char *buf, const struct kernel_param *kp)
+{
+    /* Las toca el temporizador sin cerrojo: lectura aproximada */
+    u64 n = READ_ONCE(medida.periodos);
+    int len;
+
+    len = sysfs_emit(buf, "modo=%s periodo_ns=%llu periodos=%llu perdidos=%llu",
+                     modo_hrtimer ? "hrtimer" : "jiffies", READ_ONCE(medida.periodo_ns), n,
+                     READ_ONCE(medida.perdidos));
+    if (n)
+        len += sysfs_emit_at(buf, len, " jitter_medio_ns=%llu jitter_max_ns=%llu deriva_ns=%lld",
+                             div64_u64(READ_ONCE(medida.jitter_total_ns), n),
+                             READ_ONCE(medida.jitter_max_ns), READ_ONCE(medida.deriva_ns));
+    len += sysfs_emit_at(buf, len, "\n");
+
+    spin_lock_irq(&estado_lock);
+    len += sysfs_emit_at(buf, len, "estado=%s avances=%llu pasos=%llu perdidos=%llu extra=%llu\n",
+                         en_marcha ? "running" : "paused", avances, pasos, perdidos_total, extra);
+    spin_unlock_irq(&estado_lock);
+    return len;
+}
+
+/* Sin .set el parser de insmod (parse_one) llamaría a un puntero nulo */
+static int estadisticas_set(const char *val, const struct kernel_param *kp)
+{
+    return -EPERM;
+}
+
+static const struct kernel_param_ops estadisticas_ops = {
+    .set = estadisticas_set,
+    .get = estadisticas_get,
+};
+module_param_cb(estadisticas, &estadisticas_ops, NULL, 0444);
+MODULE_PARM_DESC(estadisticas, "jitter y deriva del periodo (solo lectura)");
+
+/* Todas las líneas en una sola llamada: el núcleo GPIO agrupa por chip */
 static inline int set_pi_leds(unsigned int mask)
 {
-    int i;
-    for (i = 0; i < NR_GPIO_LEDS; i++)
-        gpiod_set_value(gpio_descriptors[i], (mask >> i) & 0x1);
-    return 0;
+    unsigned long valores = mask;
+    return gpiod_set_array_value(NR_GPIO_LEDS, gpio_descriptors, NULL, &valores);
+}
+
+static inline unsigned long periodo_jiffies(void)
+{
+    return max_t(unsigned long, nsecs_to_jiffies(READ_ONCE(periodo_ns)), 1);
 }
 
-static irqreturn_t gpio_irq_handler(int irq, void *dev_id)
+/* Empieza una medida nueva en el primer vencimiento */
+static void arrancar_temporizador(void)
 {
-#ifdef MANUAL_DEBOUNCE
-    static unsigned long last_interrupt = 0;
-    unsigned long diff = jiffies - last_interrupt;
-    if (diff < 20)
-        return IRQ_HANDLED;
+    medida.t0_ns = 0;
+    if (modo_hrtimer)
+        hrtimer_start(&my_hrtimer, ns_to_ktime(READ_ONCE(periodo_ns)), HRTIMER_MODE_REL);
+    else
+        mod_timer(&my_timer, jiffies + periodo_jiffies());
+}
 
-    last_interrupt = jiffies;
-#endif
-    // Detener el temporizador
-    if (timer_pending(&my_timer))
-    {
+static void parar_temporizador(void)
+{
+    if (modo_hrtimer)
+        hrtimer_cancel(&my_hrtimer);
+    else
         del_timer_sync(&my_timer);
-        printk(KERN_INFO "Timer stopped by button press.\n");
+}
+
+static void avanzar_contador(void)
+{
+    set_pi_leds(ledCounter);
+    ledCounter = (ledCounter + 1) % (1 << NR_GPIO_LEDS);
+}
+
+/* Llamar con control_mutex */
+static void pausar_locked(void)
+{
+    bool estaba;
+
+    spin_lock_irq(&estado_lock);
+    estaba = en_marcha;
+    en_marcha = false;
+    spin_unlock_irq(&estado_lock);
+
+    /* Ya no se rearma: basta con esperar al callback que esté en curso */
+    if (estaba)
+        parar_temporizador();
+}
+
+/* Llamar con control_mutex */
+static void reanudar_locked(void)
+{
+    spin_lock_irq(&estado_lock);
+    if (en_marcha) {
+        spin_unlock_irq(&estado_lock);
+        return;
     }
-    else
+    en_marcha = true;
+    spin_unlock_irq(&estado_lock);
+
+    arrancar_temporizador();
+}
+
+/* /sys/module/timerleds/parameters/control: pause, resume, toggle o step */
+static int control_set(const char *val, const struct kernel_param *kp)
+{
+    int err = 0;
+
+    mutex_lock(&control_mutex);
+    if (!listo)
+        err = -EAGAIN;
+    else if (sysfs_streq(val, "pause"))
+        pausar_locked();
+    else if (sysfs_streq(val, "resume"))
+        reanudar_locked();
+    else if (sysfs_streq(val, "toggle")) {
+        if (READ_ONCE(en_marcha))
+            pausar_locked();
+        else
+            reanudar_locked();
+    } else if (sysfs_streq(val, "step")) {
+        /* Un avance a mano; solo tiene sentido con el contador pausado */
+        spin_lock_irq(&estado_lock);
+        if (en_marcha)
+            err = -EBUSY;
+        else {
+            avanzar_contador();
+            pasos++;
+        }
+        spin_unlock_irq(&estado_lock);
+    } else
+        err = -EINVAL;
+    mutex_unlock(&control_mutex);
+    return err;
+}
+
+static int control_get(char *buf, const struct kernel_param *kp)
+{
+    return sysfs_emit(buf, "%s\n", READ_ONCE(en_marcha) ? "running" : "paused");
+}
+
+static const struct kernel_param_ops control_ops = {
+    .set = control_set,
+    .get = control_get,
+};
+module_param_cb(control, &control_ops, NULL, 0644);
+MODULE_PARM_DESC(control, "pause, resume, toggle o step; al leer, running o paused");
+
+/* Hilo de la interrupción: un evento ya sin rebotes */
+static void evento_boton(struct antirrebote *ar, const struct antirrebote_evento *ev)
+{
+    if (ev->tipo == ANTIRREBOTE_PULSACION)
+    {
+        mutex_lock(&control_mutex);
+        // Detener el temporizador (fuera de init/exit, listo == true)
+        if (listo && en_marcha)
+        {
+            pausar_locked();
+            printk(KERN_INFO "Timer stopped by button press.\n");
+        }
+        else if (listo)
+        {
+            reanudar_locked();
+            printk(KERN_INFO "Timer reactivated by button press.\n");
+        }
+        mutex_unlock(&control_mutex);
+    }
+    else if (ev->tipo == ANTIRREBOTE_LARGA)
     {
-        mod_timer(&my_timer, jiffies + msecs_to_jiffies(timer_period_ms));
-        printk(KERN_INFO "Timer reactivated by button press.\n");
+        spin_lock_irq(&estado_lock);
+        ledCounter = 0;
+        spin_unlock_irq(&estado_lock);
+        printk(KERN_INFO "Counter reset by long press.\n");
     }
-    return IRQ_HANDLED;
+    boton_eventos_publicar(&eventos, ev);
 }
 
 static void fire_timer(struct timer_list *timer)
 {
-    static char flag = 0;
-    flag = ~flag;
+    unsigned long flags;
 
-    set_pi_leds(ledCounter);
-    ledCounter = (ledCounter + 1) % (1 << NR_GPIO_LEDS);
+    spin_lock_irqsave(&estado_lock, flags);
+    if (!en_marcha) {
+        extra++;
+        spin_unlock_irqrestore(&estado_lock, flags);
+        return;
+    }
+    medir_periodo(ktime_get_ns(), 0);
+    avanzar_contador();
+    avances++;
+
+    mod_timer(timer, jiffies + periodo_jiffies());
+    spin_unlock_irqrestore(&estado_lock, flags);
+}
 
-    mod_timer(timer, jiffies + msecs_to_jiffies(timer_period_ms));
+/* El siguiente plazo es el anterior más un periodo, no ahora más un periodo */
+static enum hrtimer_restart fire_hrtimer(struct hrtimer *timer)
+{
+    u64 ahora = ktime_get_ns();
+    u64 vueltas;
+    unsigned long flags;
+
+    spin_lock_irqsave(&estado_lock, flags);
+    if (!en_marcha) {
+        extra++;
+        spin_unlock_irqrestore(&estado_lock, flags);
+        return HRTIMER_NORESTART;
+    }
+
+    /* Avanza el plazo en periodos enteros hasta dejarlo en el futuro: más de uno si se perdió alguno */
+    vueltas = hrtimer_forward(timer, ns_to_ktime(ahora), ns_to_ktime(READ_ONCE(periodo_ns)));
+
+    medir_periodo(ahora, vueltas - 1);
+    avanzar_contador();
+    avances++;
+    perdidos_total += vueltas - 1;
+    spin_unlock_irqrestore(&estado_lock, flags);
+    return HRTIMER_RESTART;
 }
 
 int init_timerleds(void)
@@ -82,18 +400,23 @@ int init_timerleds(void)
     char gpio_str[10];
     unsigned char gpio_out_ok = 0;
 
-    if (timer_period_ms <= 0) {
-        pr_err("Invalid timer_period_ms: must be > 0\n");
+    if (periodo_ns == 0) {
+        pr_err("Invalid timer_period_ms/timer_period_us: must be set\n");
+        return -EINVAL;
+    }
+    if (sysfs_streq(modo, "hrtimer"))
+        modo_hrtimer = true;
+    else if (!sysfs_streq(modo, "jiffies")) {
+        pr_err("Invalid modo: must be jiffies or hrtimer\n");
         return -EINVAL;
     }
 
     printk(KERN_INFO "Initializing timerleds module...\n");
-	printk(KERN_INFO "timer_period_ms is : %d\n", timer_period_ms);
+	printk(KERN_INFO "timer period is : %llu ns (%s)\n", periodo_ns, modo);
 
     timer_setup(&my_timer, fire_timer, 0);
-    my_timer.expires = jiffies + msecs_to_jiffies(timer_period_ms);
-
-    add_timer(&my_timer);
+    hrtimer_init(&my_hrtimer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    my_hrtimer.function = fire_hrtimer;
 
     for (i = 0; i < NR_GPIO_LEDS; i++)
     {
@@ -118,16 +441,16 @@ int init_timerleds(void)
     }
 
     /* Requesting Button's GPIO */
-    if ((err = gpio_request(GPIO_BUTTON, "button")))
+    if ((err = gpio_request(button_gpio, "button")))
     {
-        pr_err("ERROR: GPIO %d request\n", GPIO_BUTTON);
+        pr_err("ERROR: GPIO %d request\n", button_gpio);
         goto err_handle;
     }
 
     /* Configure Button */
-    if (!(desc_button = gpio_to_desc(GPIO_BUTTON)))
+    if (!(desc_button = gpio_to_desc(button_gpio)))
     {
-        pr_err("GPIO %d is not valid\n", GPIO_BUTTON);
+        pr_err("GPIO %d is not valid\n", button_gpio);
         err = -EINVAL;
         goto err_handle;
     }
@@ -138,33 +461,28 @@ int init_timerleds(void)
     gpiod_direction_input(desc_button);
 
     /*
-    ** The lines below are commented because gpiod_set_debounce is not supported
-    ** in the Raspberry pi. Debounce is handled manually in this driver.
+    ** gpiod_set_debounce no está soportado en la Raspberry Pi: los rebotes
+    ** se filtran con el antirrebote común.
     */
-#ifndef MANUAL_DEBOUNCE
-    // Debounce the button with a delay of 200ms
-    if (gpiod_set_debounce(desc_button, 200) < 0)
-    {
-        pr_err("ERROR: gpio_set_debounce - %d\n", GPIO_BUTTON);
+    if ((err = boton_eventos_registrar(&eventos, "timerleds_eventos")))
         goto err_handle;
-    }
-#endif
-
-    // Get the IRQ number for our GPIO
-    gpio_button_irqn = gpiod_to_irq(desc_button);
-    pr_info("IRQ Number = %d\n", gpio_button_irqn);
-
-    if (request_irq(gpio_button_irqn,    // IRQ number
-                    gpio_irq_handler,    // IRQ handler
-                    IRQF_TRIGGER_RISING, // Handler will be called in raising edge
-                    "button_leds",       // used to identify the device name using this IRQ
-                    NULL))
-    { // device id for shared IRQ
+
+    // Pide la IRQ en ambos flancos
+    if ((err = antirrebote_iniciar(&antirrebote, desc_button, debounce_us, larga_ms,
+                                   evento_boton, "button_leds")))
+    {
         pr_err("my_device: cannot register IRQ ");
+        boton_eventos_quitar(&eventos);
         goto err_handle;
     }
 
     set_pi_leds(ALL_LEDS_OFF);
+
+    // Al final: el temporizador ya encuentra los LEDs pedidos
+    mutex_lock(&control_mutex);
+    listo = true;
+    reanudar_locked();
+    mutex_unlock(&control_mutex);
     return 0;
 err_handle:
     for (j = 0; j < i; j++)
@@ -182,9 +500,14 @@ void cleanup_timerleds(void)
 
     printk(KERN_INFO "Cleaning up timerleds module...\n");
 
-    del_timer_sync(&my_timer);
+    // Primero el botón, que podría reanudar el contador
+    antirrebote_parar(&antirrebote);
+    mutex_lock(&control_mutex);
+    listo = false;
+    pausar_locked();
+    mutex_unlock(&control_mutex);
 
-    free_irq(gpio_button_irqn, NULL);
+    boton_eventos_quitar(&eventos);
     set_pi_leds(ALL_LEDS_OFF);
 
     for (i = 0; i < NR_GPIO_LEDS; i++)
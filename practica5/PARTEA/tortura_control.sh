@@ -0,0 +1,68 @@
+#!/bin/bash
+
+# Prueba de tortura del control de timerleds sobre un chip GPIO simulado:
+# durante unos segundos varios procesos escriben pause/resume/toggle/step
+# en el fichero de control mientras se inyectan pulsaciones del botón (que
+# alternan desde el hilo de la IRQ). Después comprueba que:
+#   - pausado, el contador no avanza nada;
+#   - cada step pausado avanza exactamente una vez y con el contador en
+#     marcha se rechaza;
+#   - tras resume vuelve a avanzar.
+# Uso (como root, desde este directorio): ./tortura_control.sh [segundos] [escritores]
+
+source ../../practica3/TestBee/gpio_simulado.sh
+
+SEGUNDOS=${1:-10}
+ESCRITORES=${2:-4}
+PARAMETROS=/sys/module/timerleds/parameters
+CONTROL=$PARAMETROS/control
+BOTON=3 # Offset del botón en el chip simulado
+
+campo() { grep -o "$1=[0-9]*" $PARAMETROS/estadisticas | cut -d= -f2; }
+fallo() { echo "FALLO: $*"; rmmod timerleds; gpio_simulado_destruir; exit 1; }
+
+base=$(gpio_simulado_crear 4) || exit 1
+rmmod timerleds 2>/dev/null
+insmod timerleds.ko modo=hrtimer timer_period_us=50 debounce_us=500 larga_ms=0 \
+    led_gpio=$(gpio_simulado_lineas $base 3) button_gpio=$((base + BOTON)) || exit 1
+
+fin=$(( $(date +%s) + SEGUNDOS ))
+ordenes=(pause resume toggle step)
+for e in $(seq $ESCRITORES); do
+    while [ $(date +%s) -lt $fin ]; do
+        echo ${ordenes[RANDOM % 4]} > $CONTROL 2>/dev/null
+    done &
+done
+while [ $(date +%s) -lt $fin ]; do
+    gpio_simulado_poner $BOTON 1
+    sleep 0.002
+    gpio_simulado_poner $BOTON 0
+    sleep 0.002
+done &
+wait
+sleep 0.1
+
+cat $PARAMETROS/estadisticas
+
+echo pause > $CONTROL
+[ "$(cat $CONTROL)" = paused ] || fallo "control no dice paused"
+a0=$(campo avances)
+sleep 0.5
+a1=$(campo avances)
+[ "$a0" = "$a1" ] || fallo "pausado avanzó $((a1 - a0)) veces"
+
+p0=$(campo pasos)
+for i in $(seq 10); do echo step > $CONTROL || fallo "step rechazado en pausa"; done
+p1=$(campo pasos)
+[ $((p1 - p0)) -eq 10 ] || fallo "10 steps dieron $((p1 - p0)) avances"
+[ "$(campo avances)" = "$a1" ] || fallo "step movió el temporizador"
+
+echo resume > $CONTROL
+sleep 0.2
+echo step > $CONTROL 2>/dev/null && fallo "step aceptado en marcha"
+[ "$(campo avances)" -gt "$a1" ] || fallo "no avanza tras resume"
+
+cat $PARAMETROS/estadisticas
+rmmod timerleds
+gpio_simulado_destruir
+echo OK
@@ -14,6 +14,7 @@
 #include <linux/interrupt.h>
 #include <linux/timer.h>
 #include <linux/spinlock.h>
+#include "antirrebote.h"
 
 #define DEVICE_NAME "buzzer"
 #define PWM_DEVICE_NAME "pwmchip0"
@@ -53,16 +54,29 @@ typedef enum
     REQUEST_RESUME, /* Usuario pulsó SW1 durante estado BUZZER_PAUSED */
     REQUEST_PAUSE,  /* Usuario pulsó SW1 durante estado BUZZER_PLAYING */
     REQUEST_CONFIG, /* Usuario está configurando actualmente una nueva melodía vía /dev/buzzer */
+    REQUEST_STOP,   /* Usuario mantuvo SW1 pulsado (pulsación larga) */
     REQUEST_NONE    /* Indicador de petición ya gestionada (a establecer por tarea diferida) */
 } buzzer_request_t;
 static buzzer_request_t buzzer_request = REQUEST_NONE;
 
 /* BUTTON */
 
-#define MANUAL_DEBOUNCE
 #define GPIO_BUTTON 22
 struct gpio_desc *desc_button = NULL;
-static int gpio_button_irqn = -1;
+
+static unsigned int debounce_us = 20000;
+module_param(debounce_us, uint, 0444);
+MODULE_PARM_DESC(debounce_us, "Tiempo que SW1 debe estar estable para contar una pulsación (us)");
+
+static unsigned int larga_ms = 1000;
+module_param(larga_ms, uint, 0444);
+MODULE_PARM_DESC(larga_ms, "Pulsación larga, que detiene la melodía (ms, 0 = desactivada)");
+
+/* Antirrebote común: entrega las pulsaciones a button_event() */
+static struct antirrebote antirrebote;
+
+/* La pulsación en curso empezó con la melodía sonando o en pausa */
+static bool pulsada_con_melodia = false;
 
 /* TIMER */
 
@@ -75,7 +89,7 @@ static inline int is_end_marker(struct music_step *step);
 static inline int calculate_delay_ms(unsigned int note_len, unsigned int qnote_ref);
 static void parse_notes(const char *input_buffer, struct music_step *steps, size_t *step_count);
 static void timer_handler(struct timer_list *timer);
-static irqreturn_t button_irq_handler(int irq, void *dev_id);
+static void button_event(struct antirrebote *ar, const struct antirrebote_evento *ev);
 static void my_wq_function(struct work_struct *work);
 static ssize_t buzzer_write(struct file *file, const char __user *buffer, size_t len, loff_t *offset);
 static ssize_t buzzer_read(struct file *file, char __user *buffer, size_t len, loff_t *offset);
@@ -178,38 +192,40 @@ static void timer_handler(struct timer_list *timer)
     spin_unlock_irqrestore(&lock, flags);
 }
 
-static irqreturn_t button_irq_handler(int irq, void *dev_id)
+/* Hilo de la interrupción: pulsación de SW1 ya sin rebotes */
+static void button_event(struct antirrebote *ar, const struct antirrebote_evento *ev)
 {
     unsigned long flags;
 
-#ifdef MANUAL_DEBOUNCE
-    static unsigned long last_interrupt = 0;
-    unsigned long diff = jiffies - last_interrupt;
-    if (diff < 20)
-        return IRQ_HANDLED;
-
-    last_interrupt = jiffies;
-#endif
+    if (ev->tipo == ANTIRREBOTE_LIBERACION)
+        return;
 
     spin_lock_irqsave(&lock, flags);
-    if (buzzer_state == BUZZER_STOPPED)
+    if (ev->tipo == ANTIRREBOTE_LARGA)
     {
-        buzzer_request = REQUEST_START;
-        schedule_work(&my_work);
+        /* Solo detiene si la pulsación no fue la que arrancó la melodía */
+        if (pulsada_con_melodia && buzzer_state != BUZZER_STOPPED)
+        {
+            buzzer_request = REQUEST_STOP;
+            schedule_work(&my_work);
+        }
     }
-    else if (buzzer_state == BUZZER_PAUSED)
+    else if (buzzer_state == BUZZER_STOPPED)
     {
-        buzzer_request = REQUEST_RESUME;
+        pulsada_con_melodia = false;
+        buzzer_request = REQUEST_START;
         schedule_work(&my_work);
     }
-    else if (buzzer_state == BUZZER_PLAYING)
+    else
     {
-        buzzer_request = REQUEST_PAUSE;
+        pulsada_con_melodia = true;
+        if (buzzer_state == BUZZER_PAUSED)
+            buzzer_request = REQUEST_RESUME;
+        else
+            buzzer_request = REQUEST_PAUSE;
         schedule_work(&my_work);
     }
     spin_unlock_irqrestore(&lock, flags);
-
-    return IRQ_HANDLED;
 }
 
 /* Work's handler function */
@@ -219,7 +235,7 @@ static void my_wq_function(struct work_struct *work)
 
     spin_lock_irqsave(&lock, flags);
 
-    if (buzzer_request == REQUEST_CONFIG)
+    if (buzzer_request == REQUEST_CONFIG || buzzer_request == REQUEST_STOP)
     {
         pwm_disable(pwm_device);
         buzzer_state = BUZZER_STOPPED;
@@ -433,25 +449,13 @@ static int __init buzzer_init(void)
     INIT_WORK(&my_work, my_wq_function);
     timer_setup(&my_timer, timer_handler, 0);
 
-#ifndef MANUAL_DEBOUNCE
-    // Debounce the button with a delay of 200ms
-    if (gpiod_set_debounce(desc_button, 200) < 0)
+    /*
+    ** gpiod_set_debounce no está soportado en la Raspberry Pi: se usa el
+    ** antirrebote común, que pide la IRQ en ambos flancos.
+    */
+    if ((err = antirrebote_iniciar(&antirrebote, desc_button, debounce_us, larga_ms,
+                                   button_event, "button_leds")))
     {
-        pr_err("ERROR: gpio_set_debounce - %d\n", GPIO_BUTTON);
-        goto err_handle;
-    }
-#endif
-
-    // Get the IRQ number for our GPIO
-    gpio_button_irqn = gpiod_to_irq(desc_button);
-    pr_info("IRQ Number = %d\n", gpio_button_irqn);
-
-    if (request_irq(gpio_button_irqn,    // IRQ number
-                    button_irq_handler,  // IRQ handler
-                    IRQF_TRIGGER_RISING, // Handler will be called in raising edge
-                    "button_leds",       // used to identify the device name using this IRQ
-                    NULL))
-    { // device id for shared IRQ
         pr_err("my_device: cannot register IRQ ");
         goto err_handle;
     }
@@ -469,11 +473,11 @@ err_handle:
 
 static void __exit buzzer_exit(void)
 {
+    antirrebote_parar(&antirrebote);
     del_timer_sync(&my_timer);
     flush_work(&my_work);
     pwm_free(pwm_device);
     misc_deregister(&buzzer_misc);
-    free_irq(gpio_button_irqn, NULL);
     gpiod_put(desc_button);
     printk(KERN_INFO "buzzer: Module unloaded\n");
 }